@@ -2,6 +2,9 @@
 #include <cmath>
 #include <vector>
 #include <algorithm>
+#include "../../WEEK4/Clip.h" // Clipping stage shared with the X11 demo
+#include "../../WEEK4/Lines.h" // Garis anti-aliasing Wu
+#include "../../WEEK4/Gamma.h"
 using namespace std;
 
 #define STB_IMAGE_IMPLEMENTATION
@@ -9,10 +12,8 @@ using namespace std;
 #define STB_IMAGE_WRITE_IMPLEMENTATION
 #include "stb_image_write.h"
 
-void drawPixel(unsigned char* data, int width, int height, int channels, int x, int y, unsigned char r, unsigned char g, unsigned char b) {
-    if (x < 0 || x >= width || y < 0 || y >= height) {
-        return;
-    }
+// Tidak ada cek batas di sini: garis sudah di-clip ke gambar sebelum digambar.
+void drawPixel(unsigned char* data, int width, int channels, int x, int y, unsigned char r, unsigned char g, unsigned char b) {
     int index = (y * width + x) * channels;
     data[index]     = r;
     data[index + 1] = g;
@@ -22,6 +23,44 @@ void drawPixel(unsigned char* data, int width, int height, int channels, int x,
     }
 }
 
+// Target untuk rasterizer di WEEK4/Lines.h, menggambar langsung ke data gambar.
+struct ImageTarget {
+    unsigned char* data;
+    int width, height, channels;
+    unsigned char r, g, b;
+
+    ClipRect clipRect() const {
+        return {0, 0, width - 1, height - 1};
+    }
+
+    void plot(int x, int y) {
+        drawPixel(data, width, channels, x, y, r, g, b);
+    }
+
+    // Campur warna garis dengan piksel gambar sesuai coverage (gamma-correct, lihat Gamma.h)
+    void plotCoverage(int x, int y, int coverage) {
+        int index = (y * width + x) * channels;
+        data[index]     = blendChannel(GAMMA_TABLES, data[index], r, coverage);
+        data[index + 1] = blendChannel(GAMMA_TABLES, data[index + 1], g, coverage);
+        data[index + 2] = blendChannel(GAMMA_TABLES, data[index + 2], b, coverage);
+        if (channels == 4) {
+            data[index + 3] = 255;
+        }
+    }
+
+    void hspan(int x1, int x2, int y) {
+        for (int x = min(x1, x2); x <= max(x1, x2); ++x) {
+            plot(x, y);
+        }
+    }
+
+    void vspan(int x, int y1, int y2) {
+        for (int y = min(y1, y2); y <= max(y1, y2); ++y) {
+            plot(x, y);
+        }
+    }
+};
+
 void lineBruteForce(unsigned char* data, int width, int height, int channels, int x1, int y1, int x2, int y2, unsigned char r, unsigned char g, unsigned char b) {
     // cek agar gk diabgi 0
     bool steep = abs(y2 - y1) > abs(x2 - x1); 
@@ -34,14 +73,17 @@ void lineBruteForce(unsigned char* data, int width, int height, int channels, in
         swap(y1, y2);
     }
 
+    const ClipRect image_rect = {0, 0, width - 1, height - 1};
+
     if (x1 == x2) {
+        // Setelah swap, x1 == x2 berarti garisnya cuma satu titik
         int startY = min(y1, y2);
         int endY = max(y1, y2);
         for (int y = startY; y <= endY; ++y) {
-            if (steep) {
-                drawPixel(data, width, height, channels, y, x1, r, g, b);
-            } else {
-                drawPixel(data, width, height, channels, x1, y, r, g, b);
+            int px = steep ? y : x1;
+            int py = steep ? x1 : y;
+            if (computeOutCode(px, py, image_rect) == CLIP_INSIDE) {
+                drawPixel(data, width, channels, px, py, r, g, b);
             }
         }
         return;
@@ -49,13 +91,24 @@ void lineBruteForce(unsigned char* data, int width, int height, int channels, in
     
     double m = static_cast<double>(y2 - y1) / (x2 - x1);
 
-    for (int x = x1; x <= x2; ++x) {
+    // Clip dulu: cari langkah x pertama dan terakhir yang pikselnya ada di dalam gambar
+    auto pixelAt = [&](int i) {
+        int x = x1 + i;
+        int rounded_y = static_cast<int>(round(m * (x - x1) + y1));
+        return steep ? make_pair(rounded_y, x) : make_pair(x, rounded_y);
+    };
+    int first, last;
+    if (!clipLineSteps(image_rect, x2 - x1, pixelAt, first, last)) {
+        return;
+    }
+
+    for (int x = x1 + first; x <= x1 + last; ++x) {
         double y = m * (x - x1) + y1;
         int rounded_y = static_cast<int>(round(y));
         if (steep) {
-            drawPixel(data, width, height, channels, rounded_y, x, r, g, b);
+            drawPixel(data, width, channels, rounded_y, x, r, g, b);
         } else {
-            drawPixel(data, width, height, channels, x, rounded_y, r, g, b);
+            drawPixel(data, width, channels, x, rounded_y, r, g, b);
         }
     }
 }
@@ -88,10 +141,19 @@ int main() {
     cout << "Masukkan koordinat titik kedua (x2 y2): ";
     cin >> x2 >> y2;
 
+    int algoritma;
+    cout << "Pilih algoritma (1 = Brute-Force, 2 = Wu anti-aliasing): ";
+    cin >> algoritma;
+
     unsigned char r = 255, g = 0, b = 0; // Warna merah
     cout << "Menggambar garis merah..." << endl;
 
-    lineBruteForce(img, width, height, channels, x1, y1, x2, y2, r, g, b);
+    if (algoritma == 2) {
+        ImageTarget target = {img, width, height, channels, r, g, b};
+        drawLineWu(target, x1, y1, x2, y2);
+    } else {
+        lineBruteForce(img, width, height, channels, x1, y1, x2, y2, r, g, b);
+    }
 
     if (stbi_write_png(outputFilename, width, height, channels, img, width * channels) == 0) {
         cerr << "Error: Could not save image to '" << outputFilename << "'." << endl;
@@ -0,0 +1,799 @@
+// --- Headless Benchmark ---
+// Renders synthetic workloads into an in-memory framebuffer with every line
+// algorithm and reports throughput and frame time percentiles. It never
+// talks to X, so it runs on machines without a display (e.g. in CI).
+//
+// Build:  g++ -O2 -march=native -pthread Benchmark.cpp -o Benchmark
+// Run:    ./Benchmark                      (every workload, every algorithm)
+//         ./Benchmark --workload long --algo bresenham --frames 500
+//         ./Benchmark --threads 8          (also run the tiled renderer)
+//         ./Benchmark --workload objparse --obj mesh.obj   (OBJ loading speed)
+//         g++ -O2 -pthread ...             (without -march=native: the SSE2 kernels only,
+//                                           e.g. to compare them with the AVX/AVX2 ones)
+//         ./Benchmark --check              (self-checks only)
+#include <iostream>
+#include <array>
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <chrono>
+#include <unistd.h>
+#include "Clip.h"
+#include "Framebuffer.h"
+#include "Lines.h"
+#include "Circles.h"
+#include "Transform.h"
+#include "Scene.h"
+#include "TileRenderer.h"
+#include "Checks.h"
+#include "ObjLoader.h"
+#include "Collisions.h"
+
+using namespace std;
+
+using Clock = chrono::steady_clock;
+
+struct BenchmarkOptions {
+    string workload = "all";
+    string algo = "all";
+    int frames = 200;
+    int count = -1; // Primitives per frame, -1 = the workload's default
+    int width = WINDOW_WIDTH;
+    int height = WINDOW_HEIGHT;
+    int threads = 0; // > 0 also runs the tiled renderer
+    unsigned seed = 1;
+    string obj_path; // For objparse: parse this file instead of a generated one
+};
+
+// Counts the pixels a workload draws, so throughput can be reported in pixels.
+struct PixelCounter {
+    ClipRect rect;
+    long long pixels = 0;
+
+    ClipRect clipRect() const {
+        return rect;
+    }
+
+    void plot(int, int) {
+        pixels++;
+    }
+
+    void plotCoverage(int, int, int) {
+        pixels++;
+    }
+
+    void hspan(int x1, int x2, int) {
+        pixels += abs(x2 - x1) + 1;
+    }
+
+    void vspan(int, int y1, int y2) {
+        pixels += abs(y2 - y1) + 1;
+    }
+};
+
+// A framebuffer that owns its pixels.
+struct OffscreenFramebuffer {
+    vector<uint32_t> storage;
+    Framebuffer fb;
+
+    OffscreenFramebuffer(int width, int height) : storage(width * height, 0) {
+        fb.pixels = storage.data();
+        fb.width = width;
+        fb.height = height;
+        fb.stride = width;
+        fb.clip = {0, 0, width - 1, height - 1};
+        fb.color = 0x000000;
+    }
+};
+
+const uint32_t BACKGROUND = 0xFFFFFF;
+
+// --- Workloads ---
+// One frame's primitives. "animated" workloads call step() before each frame.
+struct Workload {
+    string name;
+    vector<Line> lines;
+    vector<Circle> circles;
+    vector<Ellipse> ellipses;
+    vector<Polygon> polygons;
+    ScreenVertices mesh_vertices; // Solid meshes, filled triangle by triangle
+    vector<array<int, 3>> triangles;
+    vector<pair<int, int>> mesh_edges; // Their wireframe, for the hidden-line cases
+    bool animated = false;
+    SceneAnimation animation;
+    SceneMeshes meshes;
+    vector<Line> user_lines; // Static part of an animated scene
+
+    void step() {
+        if (!animated) {
+            return;
+        }
+        animation.step();
+        meshes.transform(animation.pose());
+        lines.assign(user_lines.begin(), user_lines.end());
+        appendEdgeLines(lines, meshes.cube_screen, cube_edges);
+        appendEdgeLines(lines, meshes.spine_screen, meshes.spineEdges());
+    }
+};
+
+int randomInt(int lo, int hi) {
+    return lo + rand() % (hi - lo + 1);
+}
+
+// Cubes at random places, depths and angles, appended to the workload's mesh.
+void addRandomCubes(Workload& w, int n, int W, int H) {
+    VertexArray cube = makeVertexArray(cube_vertices);
+    const Mat4 view_projection = sceneViewProjection();
+    const Viewport viewport = {0, 0, (float)W, (float)H};
+    ScreenVertices screen;
+    for (int i = 0; i < n; i++) {
+        Mat4 model = Mat4::translation(randomInt(-W / 2, W / 2), randomInt(-H / 2, H / 2), -randomInt(200, 1600)) *
+                     Mat4::rotationY(randomInt(0, 628) * 0.01f);
+        transformVertices(cube, view_projection * model, viewport, screen);
+        int base = static_cast<int>(w.mesh_vertices.x.size());
+        w.mesh_vertices.x.insert(w.mesh_vertices.x.end(), screen.x.begin(), screen.x.end());
+        w.mesh_vertices.y.insert(w.mesh_vertices.y.end(), screen.y.begin(), screen.y.end());
+        w.mesh_vertices.z.insert(w.mesh_vertices.z.end(), screen.z.begin(), screen.z.end());
+        for (const auto& t : cube_triangles) {
+            w.triangles.push_back({base + t[0], base + t[1], base + t[2]});
+        }
+        for (const auto& e : cube_edges) {
+            w.mesh_edges.push_back({base + e.first, base + e.second});
+        }
+    }
+}
+
+Workload makeWorkload(const string& name, const BenchmarkOptions& opt) {
+    Workload w;
+    w.name = name;
+    const int W = opt.width, H = opt.height;
+    if (name == "short") {
+        // Lots of tiny lines, where per-line setup cost dominates
+        int n = opt.count > 0 ? opt.count : 100000;
+        for (int i = 0; i < n; i++) {
+            int x = randomInt(0, W - 1), y = randomInt(0, H - 1);
+            w.lines.push_back({x, y, x + randomInt(-8, 8), y + randomInt(-8, 8)});
+        }
+    } else if (name == "long") {
+        // End points anywhere on screen, where the inner loop dominates
+        int n = opt.count > 0 ? opt.count : 5000;
+        for (int i = 0; i < n; i++) {
+            w.lines.push_back({randomInt(0, W - 1), randomInt(0, H - 1), randomInt(0, W - 1), randomInt(0, H - 1)});
+        }
+    } else if (name == "octants") {
+        // Equal-length lines fanned out evenly over all 8 octants
+        int n = opt.count > 0 ? opt.count : 5000;
+        int cx = W / 2, cy = H / 2, r = min(W, H) / 2 - 1;
+        for (int i = 0; i < n; i++) {
+            double a = 2.0 * M_PI * i / n;
+            w.lines.push_back({cx, cy, cx + (int)lround(r * cos(a)), cy + (int)lround(r * sin(a))});
+        }
+    } else if (name == "offscreen") {
+        // Long lines that mostly run outside the framebuffer (clipping)
+        int n = opt.count > 0 ? opt.count : 5000;
+        for (int i = 0; i < n; i++) {
+            w.lines.push_back({randomInt(-20 * W, 21 * W), randomInt(-20 * H, 21 * H),
+                               randomInt(-20 * W, 21 * W), randomInt(-20 * H, 21 * H)});
+        }
+    } else if (name == "circles" || name == "discs" || name == "rings") {
+        // Circles of varied radius, some crossing the edge of the screen,
+        // drawn as outlines or (for fill rate) as filled discs or rings
+        CircleStyle style = (name == "discs") ? CircleStyle::FILLED
+                          : (name == "rings") ? CircleStyle::RING : CircleStyle::OUTLINE;
+        int n = opt.count > 0 ? opt.count : (style == CircleStyle::OUTLINE ? 2000 : 200);
+        for (int i = 0; i < n; i++) {
+            int radius = randomInt(1, min(W, H) / 2);
+            w.circles.push_back({randomInt(0, W - 1), randomInt(0, H - 1), radius, style, radius * 3 / 4});
+        }
+    } else if (name == "ellipses" || name == "rotated" || name == "ellipse-fill") {
+        // Axis-aligned outlines (midpoint), rotated outlines (conic stepper),
+        // or for fill rate a mix of both kinds filled
+        int n = opt.count > 0 ? opt.count : (name == "ellipse-fill" ? 200 : 2000);
+        for (int i = 0; i < n; i++) {
+            int angle = (name == "ellipses" || (name == "ellipse-fill" && i % 2 == 0)) ? 0 : randomInt(1, 89) + 90 * randomInt(0, 1);
+            w.ellipses.push_back({randomInt(0, W - 1), randomInt(0, H - 1), randomInt(1, W / 2), randomInt(1, H / 2),
+                                  angle, name == "ellipse-fill"});
+        }
+    } else if (name == "polygons") {
+        // Small random polygons: concave and self-intersecting, half of
+        // them even-odd and half non-zero
+        int n = opt.count > 0 ? opt.count : 500;
+        for (int i = 0; i < n; i++) {
+            Polygon p;
+            int cx = randomInt(0, W - 1), cy = randomInt(0, H - 1), reach = randomInt(10, 100);
+            for (int v = randomInt(3, 24); v > 0; v--) {
+                p.x.push_back(cx + randomInt(-reach, reach));
+                p.y.push_back(cy + randomInt(-reach, reach));
+            }
+            p.rule = (i % 2) ? FillRule::NON_ZERO : FillRule::EVEN_ODD;
+            buildEdgeTable(p);
+            w.polygons.push_back(p);
+        }
+    } else if (name == "bigpoly") {
+        // One polygon with tens of thousands of vertices: a ragged outline
+        // around the center, like a traced shape or a coastline
+        int n = opt.count > 0 ? opt.count : 50000;
+        Polygon p;
+        int r = min(W, H) / 3;
+        for (int i = 0; i < n; i++) {
+            double a = 2.0 * M_PI * i / n;
+            r = max(min(W, H) / 8, min(min(W, H) / 2, r + randomInt(-3, 3)));
+            p.x.push_back(W / 2 + (int)lround(r * cos(a)));
+            p.y.push_back(H / 2 + (int)lround(r * sin(a)));
+        }
+        buildEdgeTable(p);
+        w.polygons.push_back(p);
+    } else if (name == "triangles" || name == "hidden") {
+        // Solid cubes at random places and angles, 12 triangles each: many
+        // small triangles sharing edges, like a tessellated mesh. "hidden"
+        // draws their edges with the hidden ones removed.
+        int n = opt.count > 0 ? opt.count : 1000;
+        addRandomCubes(w, n, W, H);
+    } else if (name == "bigtris") {
+        // Large triangles with corners anywhere around the screen, for fill rate
+        int n = opt.count > 0 ? opt.count : 200;
+        for (int i = 0; i < n; i++) {
+            int base = static_cast<int>(w.mesh_vertices.x.size());
+            for (int v = 0; v < 3; v++) {
+                w.mesh_vertices.x.push_back(randomInt(-W / 4, W + W / 4));
+                w.mesh_vertices.y.push_back(randomInt(-H / 4, H + H / 4));
+            }
+            w.triangles.push_back({base, base + 1, base + 2});
+        }
+    } else if (name == "scene") {
+        // The demo: random user lines (like pressing R) plus the animated cube and spine
+        int n = opt.count > 0 ? opt.count : 1000;
+        for (int i = 0; i < n; i++) {
+            w.user_lines.push_back({randomInt(0, W - 1), randomInt(0, H - 1), randomInt(0, W - 1), randomInt(0, H - 1)});
+        }
+        w.animated = true;
+        w.step();
+    }
+    return w;
+}
+
+template <typename Target>
+void drawWorkload(Target& target, const Workload& w, DrawAlgorithm algo) {
+    drawUserShapes(target, w.lines, w.circles, w.ellipses, w.polygons, algo);
+    fillTriangles(target, w.mesh_vertices, w.triangles);
+}
+
+// --- Reporting ---
+double percentile(vector<double> sorted_ms, double p) {
+    if (sorted_ms.empty()) {
+        return 0.0;
+    }
+    size_t index = min(sorted_ms.size() - 1, (size_t)(p / 100.0 * (sorted_ms.size() - 1) + 0.5));
+    return sorted_ms[index];
+}
+
+void printHeader() {
+    printf("%-12s %-16s %-12s %9s %11s %9s %9s %8s %8s %8s %8s\n", "workload", "algorithm", "renderer",
+           "prims", "pixels", "Mpix/s", "ns/prim", "p50 ms", "p90 ms", "p99 ms", "max ms");
+}
+
+// Returns the mean frame time in ms.
+double report(const string& workload, const string& algo, const string& renderer, long long prims,
+            long long pixels, vector<double>& frame_ms) {
+    sort(frame_ms.begin(), frame_ms.end());
+    double total_ms = 0.0;
+    for (double ms : frame_ms) {
+        total_ms += ms;
+    }
+    double mean_ms = total_ms / frame_ms.size();
+    printf("%-12s %-16s %-12s %9lld %11lld %9.1f %9.1f %8.3f %8.3f %8.3f %8.3f\n", workload.c_str(), algo.c_str(),
+           renderer.c_str(), prims, pixels, pixels / (mean_ms * 1000.0), mean_ms * 1e6 / max(prims, 1LL),
+           percentile(frame_ms, 50), percentile(frame_ms, 90), percentile(frame_ms, 99), frame_ms.back());
+    return mean_ms;
+}
+
+// Runs one workload with one algorithm: an untimed pass to count pixels,
+// a few warm-up frames, then the timed frames. Returns the mean frame time in ms.
+double runCase(Workload w, DrawAlgorithm algo, const string& algo_name, const BenchmarkOptions& opt,
+             TileRenderer* tiles) {
+    OffscreenFramebuffer target(opt.width, opt.height);
+    Framebuffer& fb = target.fb;
+
+    PixelCounter counter;
+    counter.rect = fb.clip;
+    drawWorkload(counter, w, algo);
+    long long prims = w.lines.size() + w.circles.size() + w.ellipses.size() + w.polygons.size() + w.triangles.size();
+
+    vector<double> frame_ms;
+    frame_ms.reserve(opt.frames);
+    for (int frame = -3; frame < opt.frames; frame++) {
+        w.step();
+        Clock::time_point start = Clock::now();
+        if (tiles) {
+            tiles->render(fb, BACKGROUND, w.lines, w.circles, w.ellipses, w.polygons, algo);
+        } else {
+            fb.clear(BACKGROUND);
+            drawWorkload(fb, w, algo);
+        }
+        Clock::time_point end = Clock::now();
+        if (frame >= 0) {
+            frame_ms.push_back(chrono::duration<double, milli>(end - start).count());
+        }
+    }
+
+    string renderer = tiles ? "tiled x" + to_string(tiles->threadCount()) : "single";
+    return report(w.name, algo_name, renderer, prims, counter.pixels, frame_ms);
+}
+
+// Circle outlines walk the midpoint algorithm from scratch ("midpoint"),
+// then come from the radius-keyed octant cache ("octant-cache"), followed
+// by how well the cache did.
+void runCircleCacheCases(Workload& w, const BenchmarkOptions& opt, TileRenderer* tiles) {
+    CircleOctantCache& cache = circleOctantCache();
+    for (bool cached : {false, true}) {
+        cache.enabled = cached;
+        const string name = cached ? "octant-cache" : "midpoint";
+        runCase(w, DrawAlgorithm::BRESENHAM, name, opt, nullptr);
+        if (tiles) {
+            runCase(w, DrawAlgorithm::BRESENHAM, name, opt, tiles);
+        }
+    }
+    CircleCacheStats s = cache.stats();
+    printf("             octant cache: %.1f%% hits (%llu hits, %llu misses, %llu evictions), %zu radii / %zu points kept\n",
+           s.hitRate(), s.hits, s.misses, s.evictions, s.cached_radii, s.cached_points);
+}
+
+// Triangles are filled as 3-corner polygons by the scanline fill
+// ("scanline"), then by the edge-function rasterizer, followed by both rates
+// in triangles per second. Single-threaded only: the tile renderer bins the
+// user shapes, not meshes.
+void runTriangleCases(const Workload& w, const BenchmarkOptions& opt) {
+    Workload as_polygons = w;
+    as_polygons.triangles.clear();
+    for (const auto& t : w.triangles) {
+        Polygon p;
+        for (int v : t) {
+            p.x.push_back(w.mesh_vertices.x[v]);
+            p.y.push_back(w.mesh_vertices.y[v]);
+        }
+        buildEdgeTable(p);
+        as_polygons.polygons.push_back(p);
+    }
+#if defined(__AVX2__)
+    const char* kernel = "edge AVX2 x8";
+#elif defined(__SSE2__)
+    const char* kernel = "edge SSE2 2x4";
+#else
+    const char* kernel = "edge scalar";
+#endif
+    double scanline_ms = runCase(as_polygons, DrawAlgorithm::BRESENHAM, "scanline", opt, nullptr);
+    double edge_ms = runCase(w, DrawAlgorithm::BRESENHAM, kernel, opt, nullptr);
+    double count = static_cast<double>(w.triangles.size());
+    printf("             triangles: %.3f Mtris/s scanline, %.3f Mtris/s edge functions\n",
+           count / (scanline_ms * 1000.0), count / (edge_ms * 1000.0));
+}
+
+// Wireframes of the "hidden" cubes: all edges drawn ("bresenham"), then
+// with hidden lines removed against a depth prepass of the cubes' faces,
+// once with the epoch clear and once clearing every depth cell each frame,
+// to show what the epoch clear saves.
+void runHiddenLineCases(const Workload& w, const BenchmarkOptions& opt) {
+    OffscreenFramebuffer target(opt.width, opt.height);
+    Framebuffer& fb = target.fb;
+    DepthBuffer depth;
+    depth.resize(opt.width, opt.height);
+
+    for (int mode = 0; mode < 3; mode++) {
+        auto draw = [&](auto& out) {
+            if (mode == 0) {
+                drawEdges(out, w.mesh_vertices, w.mesh_edges, DrawAlgorithm::BRESENHAM);
+                return;
+            }
+            if (mode == 2) {
+                fill(depth.cells.begin(), depth.cells.end(), 0);
+            }
+            depth.clear();
+            writeTriangleDepth(depth, out.clipRect(), w.mesh_vertices, w.triangles);
+            drawEdgesDepth(out, depth, w.mesh_vertices, w.mesh_edges);
+        };
+        PixelCounter counter;
+        counter.rect = fb.clip;
+        draw(counter);
+        vector<double> frame_ms;
+        for (int frame = -3; frame < opt.frames; frame++) {
+            Clock::time_point start = Clock::now();
+            fb.clear(BACKGROUND);
+            draw(fb);
+            Clock::time_point end = Clock::now();
+            if (frame >= 0) {
+                frame_ms.push_back(chrono::duration<double, milli>(end - start).count());
+            }
+        }
+        const char* names[] = {"bresenham", "depth+epoch", "depth+clear"};
+        report(w.name, names[mode], "single", w.mesh_edges.size(), counter.pixels, frame_ms);
+    }
+}
+
+// Stress mode: "count" instanced cubes (10000 by default, at most
+// MAX_INSTANCES), each frame stepped, placed and projected, then drawn as
+// wireframes with each algorithm; the frame times cover all of it. The
+// update and the transform are then shown on their own.
+void runInstanceCases(const BenchmarkOptions& opt, const vector<pair<DrawAlgorithm, string>>& algorithms) {
+    OffscreenFramebuffer target(opt.width, opt.height);
+    Framebuffer& fb = target.fb;
+    SceneMeshes meshes;
+    meshes.spawnInstances(opt.count > 0 ? opt.count : 10000, opt.seed);
+    const size_t count = meshes.instances.size();
+    double update_ms = 0.0, transform_ms = 0.0;
+    int timed = 0;
+
+    for (const auto& a : algorithms) {
+        meshes.transform(SceneAnimation().pose());
+        PixelCounter counter;
+        counter.rect = fb.clip;
+        drawEdges(counter, meshes.instances_screen, meshes.instance_edges, a.first);
+        vector<double> frame_ms;
+        for (int frame = -3; frame < opt.frames; frame++) {
+            Clock::time_point start = Clock::now();
+            meshes.instances.step();
+            Clock::time_point stepped = Clock::now();
+            meshes.transform(SceneAnimation().pose());
+            Clock::time_point transformed = Clock::now();
+            fb.clear(BACKGROUND);
+            drawEdges(fb, meshes.instances_screen, meshes.instance_edges, a.first);
+            Clock::time_point end = Clock::now();
+            if (frame >= 0) {
+                frame_ms.push_back(chrono::duration<double, milli>(end - start).count());
+                update_ms += chrono::duration<double, milli>(stepped - start).count();
+                transform_ms += chrono::duration<double, milli>(transformed - stepped).count();
+                timed++;
+            }
+        }
+        report("instances", a.second, "single", meshes.instance_edges.size(), counter.pixels, frame_ms);
+    }
+#if defined(__AVX__)
+    const char* kernel = "AVX x8";
+#elif defined(__SSE2__)
+    const char* kernel = "SSE2 x4";
+#else
+    const char* kernel = "scalar";
+#endif
+    printf("             %zu instances (%s): update %.3f ms, place+transform %.3f ms per frame (%.1f ns/cube)\n",
+           count, kernel, update_ms / timed, transform_ms / timed,
+           (update_ms + transform_ms) / timed * 1e6 / max<size_t>(count, 1));
+}
+
+// Instance collisions (Collisions.h): "count" cubes (10000 by default)
+// stepped with collisions on, once per cell size, showing what the broad
+// phase (building the spatial hash and finding candidate pairs) and the
+// narrow phase (testing them and bouncing) cost per step. Then, for
+// comparison, testing every pair. The cubes bounce in a square that grows
+// with their number, one 80 x 80 px patch each on average, so the work per
+// cube stays the same at any count (in the window they would pile up).
+void runCollisionCases(const BenchmarkOptions& opt) {
+    const size_t count = min<size_t>(opt.count > 0 ? opt.count : 10000, MAX_INSTANCES);
+    const int steps = min(opt.frames, 100);
+    const float side = 80.0f * sqrt((float)count);
+    auto spawn = [&](CubeInstances& cubes) {
+        cubes.max_x = cubes.max_y = cubes.min_x + side;
+        cubes.spawn(count, opt.seed);
+    };
+    printf("collisions   %zu cubes in %.0f x %.0f px, %d steps per cell size, mean per step:\n", count, side, side,
+           steps);
+    for (float cell_size : {10.0f, 20.0f, 40.0f, 80.0f, 160.0f}) {
+        CubeInstances cubes;
+        spawn(cubes);
+        InstanceCollisions collider;
+        collider.grid.cell_size = cell_size;
+        double broad_ms = 0.0, narrow_ms = 0.0;
+        size_t candidates = 0, contacts = 0;
+        for (int step = 0; step < steps; step++) {
+            cubes.step();
+            collider.resolve(cubes);
+            broad_ms += collider.stats.broad_ms;
+            narrow_ms += collider.stats.narrow_ms;
+            candidates += collider.stats.candidates;
+            contacts += collider.stats.contacts;
+        }
+        printf("             cell %5.0f px: broad %8.3f ms, narrow %8.3f ms, %10.0f candidates, %8.0f contacts\n",
+               cell_size, broad_ms / steps, narrow_ms / steps, (double)candidates / steps, (double)contacts / steps);
+    }
+    if (count <= 20000) {
+        CubeInstances cubes;
+        spawn(cubes);
+        const float reach = 2 * COLLISION_RADIUS;
+        Clock::time_point start = Clock::now();
+        size_t contacts = 0;
+        for (size_t i = 0; i < count; i++) {
+            for (size_t j = i + 1; j < count; j++) {
+                float dx = cubes.x[j] - cubes.x[i], dy = cubes.y[j] - cubes.y[i];
+                contacts += dx * dx + dy * dy < reach * reach;
+            }
+        }
+        double ms = chrono::duration<double, milli>(Clock::now() - start).count();
+        printf("             every pair:  %8.3f ms for %zu tests, %zu contacts\n", ms, count * (count - 1) / 2,
+               contacts);
+    }
+}
+
+// Vertex transform throughput on a synthetic mesh in front of the camera.
+void runTransform(const BenchmarkOptions& opt) {
+    int n = opt.count > 0 ? opt.count : 2000000;
+    VertexArray mesh;
+    for (int i = 0; i < n; i++) {
+        mesh.x.push_back(randomInt(-2000, 2000) * 0.1f);
+        mesh.y.push_back(randomInt(-2000, 2000) * 0.1f);
+        mesh.z.push_back(randomInt(-2000, 2000) * 0.1f);
+    }
+    ScreenVertices screen;
+    const Mat4 view_projection = sceneViewProjection();
+    const Viewport viewport = {0, 0, (float)opt.width, (float)opt.height};
+
+    vector<double> frame_ms;
+    for (int frame = -3; frame < opt.frames; frame++) {
+        Mat4 mvp = view_projection * objectModelMatrix(frame * 0.015f, opt.width / 2, opt.height / 2);
+        Clock::time_point start = Clock::now();
+        transformVertices(mesh, mvp, viewport, screen);
+        Clock::time_point end = Clock::now();
+        if (frame >= 0) {
+            frame_ms.push_back(chrono::duration<double, milli>(end - start).count());
+        }
+    }
+    sort(frame_ms.begin(), frame_ms.end());
+    double total_ms = 0.0;
+    for (double ms : frame_ms) {
+        total_ms += ms;
+    }
+    double mean_ms = total_ms / frame_ms.size();
+#if defined(__AVX__)
+    const char* kernel = "AVX x8";
+#elif defined(__SSE2__)
+    const char* kernel = "SSE2 x4";
+#else
+    const char* kernel = "scalar";
+#endif
+    printf("transform    %-16s %-12s %9d %11s %9.1f %9.2f %8.3f %8.3f %8.3f %8.3f   (Mverts/s, ns/vertex)\n",
+           kernel, "single", n, "-", n / (mean_ms * 1000.0), mean_ms * 1e6 / n, percentile(frame_ms, 50),
+           percentile(frame_ms, 90), percentile(frame_ms, 99), frame_ms.back());
+}
+
+// Writes a torus of about "faces" triangles as an .obj file, the way
+// exporters do: all vertices first, then the faces. Returns its path.
+string writeTorusObj(int faces) {
+    const int rings = max(3, static_cast<int>(sqrt(faces / 2.0)));
+    const int sides = max(3, faces / (2 * rings));
+    char path[] = "/tmp/benchmark-torus-XXXXXX";
+    int fd = mkstemp(path);
+    FILE* file = fd >= 0 ? fdopen(fd, "w") : nullptr;
+    if (!file) {
+        return "";
+    }
+    const float PI = 3.14159265f;
+    for (int r = 0; r < rings; r++) {
+        for (int s = 0; s < sides; s++) {
+            float u = 2 * PI * r / rings, v = 2 * PI * s / sides;
+            fprintf(file, "v %.6f %.6f %.6f\n", (3 + cos(v)) * cos(u), sin(v), (3 + cos(v)) * sin(u));
+        }
+    }
+    for (int r = 0; r < rings; r++) {
+        for (int s = 0; s < sides; s++) {
+            int a = r * sides + s + 1, b = r * sides + (s + 1) % sides + 1;
+            int c = (r + 1) % rings * sides + (s + 1) % sides + 1, d = (r + 1) % rings * sides + s + 1;
+            fprintf(file, "f %d %d %d\nf %d %d %d\n", a, b, c, a, c, d);
+        }
+    }
+    fclose(file);
+    return path;
+}
+
+// OBJ loading throughput (ObjLoader.h) in MB/s: a generated torus of about
+// a million triangles ("count" to change it), or the --obj file. Each run
+// maps and parses the whole file, so only a few runs are made.
+void runObjParse(const BenchmarkOptions& opt) {
+    string path = opt.obj_path;
+    if (path.empty()) {
+        path = writeTorusObj(opt.count > 0 ? opt.count : 1000000);
+        if (path.empty()) {
+            cerr << "Cannot write the generated .obj file" << endl;
+            return;
+        }
+    }
+    ObjMesh mesh;
+    string error;
+    vector<double> frame_ms;
+    for (int run = -1; run < min(opt.frames, 10); run++) {
+        Clock::time_point start = Clock::now();
+        bool ok = loadObj(path, mesh, error);
+        Clock::time_point end = Clock::now();
+        if (!ok) {
+            cerr << "Cannot load " << path << ": " << error << endl;
+            break;
+        }
+        if (run >= 0) {
+            frame_ms.push_back(chrono::duration<double, milli>(end - start).count());
+        }
+    }
+    if (opt.obj_path.empty()) {
+        unlink(path.c_str());
+    }
+    if (frame_ms.empty()) {
+        return;
+    }
+    sort(frame_ms.begin(), frame_ms.end());
+    double total_ms = 0.0;
+    for (double ms : frame_ms) {
+        total_ms += ms;
+    }
+    double mean_ms = total_ms / frame_ms.size();
+    printf("objparse     %-16s %-12s %9zu %11s %9.1f %9.2f %8.3f %8.3f %8.3f %8.3f   (MB/s, ns/face)\n",
+           "mmap+parse", "single", mesh.faces, "-", mesh.bytes / (mean_ms * 1000.0), mean_ms * 1e6 / mesh.faces,
+           percentile(frame_ms, 50), percentile(frame_ms, 90), percentile(frame_ms, 99), frame_ms.back());
+    printf("             obj: %.1f MB, %zu vertices, %zu faces, %zu triangles, %zu unique edges\n",
+           mesh.bytes / 1e6, mesh.vertices.x.size(), mesh.faces, mesh.triangles.size(), mesh.edges.size());
+
+    // The edges of its triangles, found by the hash set (EdgeBuilder.h),
+    // then also sorted by vertex, against sorting all of them to drop repeats
+    auto time_ms = [](auto build) {
+        Clock::time_point start = Clock::now();
+        size_t edges = build();
+        double ms = chrono::duration<double, milli>(Clock::now() - start).count();
+        return make_pair(ms, edges);
+    };
+    auto hashed = time_ms([&] { return EdgeBuilder::fromFaces(mesh.triangles).size(); });
+    auto hashed_sorted = time_ms([&] { return EdgeBuilder::fromFaces(mesh.triangles, true).size(); });
+    auto sorted = time_ms([&] {
+        vector<pair<int, int>> edges;
+        edges.reserve(mesh.triangles.size() * 3);
+        for (const auto& t : mesh.triangles) {
+            for (int i = 0; i < 3; i++) {
+                edges.push_back(minmax(t[i], t[(i + 1) % 3]));
+            }
+        }
+        sort(edges.begin(), edges.end());
+        edges.erase(unique(edges.begin(), edges.end()), edges.end());
+        return edges.size();
+    });
+    printf("             edges of the triangles: hash %.1f ms, hash+vertex sort %.1f ms, sort+unique %.1f ms"
+           " (%zu edges)\n", hashed.first, hashed_sorted.first, sorted.first, hashed.second);
+    if (hashed.second != sorted.second || hashed_sorted.second != sorted.second) {
+        printf("             edge counts differ: %zu, %zu, %zu\n", hashed.second, hashed_sorted.second,
+               sorted.second);
+    }
+}
+
+void printUsage() {
+    cout << "Usage: Benchmark [options]\n"
+            "  --workload NAME  short | long | octants | offscreen | circles | discs | rings | ellipses\n"
+            "                   | rotated | ellipse-fill | polygons | bigpoly | triangles | bigtris | hidden\n"
+            "                   | scene | transform | objparse | instances | collisions | all\n"
+            "  --algo NAME      bruteforce | dda | dda-fixed | bresenham | runslice | wu | all\n"
+            "  --frames N       timed frames per case (default 200)\n"
+            "  --count N        primitives per frame (vertices for transform, faces for objparse,\n"
+            "                   cubes for instances and collisions)\n"
+            "  --obj FILE       parse this .obj file in objparse instead of a generated torus\n"
+            "  --size WxH       framebuffer size (default 600x600)\n"
+            "  --threads N      also run the tiled renderer on N threads\n"
+            "  --seed N         random seed for the workloads\n"
+            "  --check          run the self-checks and exit\n";
+}
+
+int main(int argc, char** argv) {
+    BenchmarkOptions opt;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--check") {
+            return runChecks();
+        } else if (arg == "--workload" && has_value) {
+            opt.workload = argv[++i];
+        } else if (arg == "--algo" && has_value) {
+            opt.algo = argv[++i];
+        } else if (arg == "--frames" && has_value) {
+            opt.frames = max(1, atoi(argv[++i]));
+        } else if (arg == "--count" && has_value) {
+            opt.count = atoi(argv[++i]);
+        } else if (arg == "--size" && has_value) {
+            if (sscanf(argv[++i], "%dx%d", &opt.width, &opt.height) != 2 || opt.width <= 0 || opt.height <= 0) {
+                cerr << "Bad --size, expected WxH" << endl;
+                return 1;
+            }
+        } else if (arg == "--threads" && has_value) {
+            opt.threads = max(0, atoi(argv[++i]));
+        } else if (arg == "--seed" && has_value) {
+            opt.seed = strtoul(argv[++i], NULL, 10);
+        } else if (arg == "--obj" && has_value) {
+            opt.obj_path = argv[++i];
+        } else {
+            printUsage();
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    const vector<pair<DrawAlgorithm, string>> all_algorithms = {
+        {DrawAlgorithm::BRUTE_FORCE, "bruteforce"}, {DrawAlgorithm::DDA, "dda"},
+        {DrawAlgorithm::DDA_FIXED, "dda-fixed"},    {DrawAlgorithm::BRESENHAM, "bresenham"},
+        {DrawAlgorithm::RUN_SLICE, "runslice"},   {DrawAlgorithm::WU, "wu"},
+    };
+    vector<pair<DrawAlgorithm, string>> algorithms;
+    for (const auto& a : all_algorithms) {
+        if (opt.algo == "all" || opt.algo == a.second) {
+            algorithms.push_back(a);
+        }
+    }
+    if (algorithms.empty()) {
+        cerr << "Unknown algorithm '" << opt.algo << "'" << endl;
+        return 1;
+    }
+
+    const vector<string> all_workloads = {"short", "long", "octants", "offscreen", "circles", "discs", "rings",
+                                          "ellipses", "rotated", "ellipse-fill", "polygons", "bigpoly", "triangles",
+                                          "bigtris", "hidden", "scene", "transform", "objparse",
+                                          "instances", "collisions"};
+    vector<string> workloads;
+    for (const string& name : all_workloads) {
+        if (opt.workload == "all" || opt.workload == name) {
+            workloads.push_back(name);
+        }
+    }
+    if (workloads.empty()) {
+        cerr << "Unknown workload '" << opt.workload << "'" << endl;
+        return 1;
+    }
+
+    TileRenderer tiles;
+    if (opt.threads > 0) {
+        tiles.init(opt.width, opt.height, opt.threads);
+    }
+
+    printf("Framebuffer %dx%d, %d frames per case\n", opt.width, opt.height, opt.frames);
+    printHeader();
+    for (const string& name : workloads) {
+        if (name == "transform") {
+            runTransform(opt);
+            continue;
+        }
+        if (name == "objparse") {
+            runObjParse(opt);
+            continue;
+        }
+        if (name == "instances") {
+            runInstanceCases(opt, algorithms);
+            continue;
+        }
+        if (name == "collisions") {
+            runCollisionCases(opt);
+            continue;
+        }
+        srand(opt.seed);
+        Workload w = makeWorkload(name, opt);
+        if (name == "circles") {
+            runCircleCacheCases(w, opt, opt.threads > 0 ? &tiles : nullptr);
+            continue;
+        }
+        if (name == "triangles" || name == "bigtris") {
+            runTriangleCases(w, opt);
+            continue;
+        }
+        if (name == "hidden") {
+            runHiddenLineCases(w, opt);
+            continue;
+        }
+        // Circles, ellipses and polygons have their own algorithm, so they run once
+        const bool own_algorithm = name == "discs" || name == "rings" || name == "ellipses" || name == "rotated" ||
+                                   name == "ellipse-fill" || name == "polygons" || name == "bigpoly";
+        const string own_name = name == "rotated" ? "conic" : name == "ellipse-fill" ? "midpoint+conic"
+                              : (name == "polygons" || name == "bigpoly") ? "scanline" : "midpoint";
+        const auto& algos = own_algorithm ? vector<pair<DrawAlgorithm, string>>{{DrawAlgorithm::BRESENHAM, own_name}}
+                                          : algorithms;
+        for (const auto& a : algos) {
+            runCase(w, a.first, a.second, opt, nullptr);
+            if (opt.threads > 0) {
+                runCase(w, a.first, a.second, opt, &tiles);
+            }
+        }
+    }
+
+    if (opt.threads > 0) {
+        tiles.shutdown();
+    }
+    return 0;
+}
@@ -0,0 +1,835 @@
+// --- Self-Checks (run with --check, no X display needed) ---
+// Each module's algorithms against a slower, obviously right version of
+// them: brute force, exact arithmetic or the standard library. Every module
+// has its own check function; runChecks runs them all.
+#ifndef CHECKS_H
+#define CHECKS_H
+
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Circles.h"
+#include "Collisions.h"
+#include "DepthBuffer.h"
+#include "EdgeBuilder.h"
+#include "Ellipses.h"
+#include "Lines.h"
+#include "ObjLoader.h"
+#include "Polygons.h"
+#include "Scene.h"
+#include "Triangles.h"
+
+// Records every pixel a rasterizer plots, in order, so two algorithms can be
+// compared pixel by pixel.
+struct PixelRecorder {
+    std::vector<std::pair<int, int>> pixels;
+    std::vector<int> coverages; // Per pixel, COVERAGE_FULL unless anti-aliased
+    ClipRect rect = {-(1 << 29), -(1 << 29), 1 << 29, 1 << 29}; // Effectively unclipped
+
+    ClipRect clipRect() const {
+        return rect;
+    }
+
+    void plot(int x, int y) {
+        plotCoverage(x, y, COVERAGE_FULL);
+    }
+
+    void plotCoverage(int x, int y, int coverage) {
+        pixels.push_back({x, y});
+        coverages.push_back(coverage);
+    }
+
+    void hspan(int x1, int x2, int y) {
+        int step = (x1 <= x2) ? 1 : -1;
+        for (int x = x1; x != x2 + step; x += step) {
+            plot(x, y);
+        }
+    }
+
+    void vspan(int x, int y1, int y2) {
+        int step = (y1 <= y2) ? 1 : -1;
+        for (int y = y1; y != y2 + step; y += step) {
+            plot(x, y);
+        }
+    }
+};
+
+// Exact value of round(a + i * d / n) with ties rounding up (n > 0).
+inline int exactRound(int a, long long i, int d, int n) {
+    long long num = 2LL * n * a + 2LL * i * d + n;
+    long long den = 2LL * n;
+    return static_cast<int>(num >= 0 ? num / den : -((-num + den - 1) / den));
+}
+
+// --- Lines ---
+inline bool checkLines() {
+    srand(12345);
+    bool ok = true;
+
+    // 1) Run-slice must visit the same pixels as Bresenham (order may differ).
+    long run_slice_mismatches = 0;
+    for (int i = 0; i < 20000; i++) {
+        int x1 = rand() % 2000 - 1000, y1 = rand() % 2000 - 1000;
+        int x2 = rand() % 2000 - 1000, y2 = rand() % 2000 - 1000;
+        PixelRecorder bresenham, run_slice;
+        drawLineBresenham(bresenham, x1, y1, x2, y2);
+        drawLineRunSlice(run_slice, x1, y1, x2, y2);
+        std::sort(bresenham.pixels.begin(), bresenham.pixels.end());
+        std::sort(run_slice.pixels.begin(), run_slice.pixels.end());
+        if (bresenham.pixels != run_slice.pixels) {
+            run_slice_mismatches++;
+        }
+    }
+    std::cout << "Run-slice vs Bresenham: " << run_slice_mismatches << " of 20000 lines differ" << std::endl;
+    ok = ok && run_slice_mismatches == 0;
+
+    // 2) Long-line accuracy: both DDAs against the exact rounded line,
+    //    over random lines in all octants with a major axis up to 40000 px.
+    long fixed_wrong = 0, float_wrong = 0, total = 0;
+    int float_worst = 0;
+    for (int i = 0; i < 2000; i++) {
+        int major = 1000 + rand() % 39000;
+        int minor = rand() % (major + 1);
+        int x1 = rand() % 2000 - 1000, y1 = rand() % 2000 - 1000;
+        int dx = (rand() % 2) ? major : -major;
+        int dy = (rand() % 2) ? minor : -minor;
+        if (rand() % 2) {
+            std::swap(dx, dy); // Steep line
+        }
+        int x2 = x1 + dx, y2 = y1 + dy;
+
+        PixelRecorder fixed_dda, float_dda;
+        drawLineDDAFixed(fixed_dda, x1, y1, x2, y2);
+        drawLineDDA(float_dda, x1, y1, x2, y2);
+
+        bool shallow = std::abs(dx) > std::abs(dy);
+        for (size_t k = 0; k < fixed_dda.pixels.size(); k++) {
+            int exact = shallow ? exactRound(y1, k, dy, std::abs(dx)) : exactRound(x1, k, dx, std::abs(dy));
+            int got_fixed = shallow ? fixed_dda.pixels[k].second : fixed_dda.pixels[k].first;
+            int got_float = shallow ? float_dda.pixels[k].second : float_dda.pixels[k].first;
+            if (got_fixed != exact) fixed_wrong++;
+            if (got_float != exact) float_wrong++;
+            float_worst = std::max(float_worst, std::abs(got_float - exact));
+        }
+        total += fixed_dda.pixels.size();
+    }
+    std::cout << "Long lines, pixels off the exact line: fixed-point DDA " << fixed_wrong
+         << ", float DDA " << float_wrong << " (worst " << float_worst << " px) of " << total << std::endl;
+    ok = ok && fixed_wrong == 0;
+
+    // 3) Clipping must not change which pixels are drawn inside the rectangle:
+    //    compare clipped lines with unclipped lines filtered afterwards.
+    const ClipRect clip = {100, 80, 699, 479};
+    const DrawAlgorithm algorithms[] = {DrawAlgorithm::BRUTE_FORCE, DrawAlgorithm::DDA, DrawAlgorithm::DDA_FIXED,
+                                        DrawAlgorithm::BRESENHAM, DrawAlgorithm::RUN_SLICE, DrawAlgorithm::WU};
+    const char* names[] = {"Brute-Force", "DDA", "Fixed-Point DDA", "Bresenham", "Run-Slice", "Wu"};
+    for (int a = 0; a < 6; a++) {
+        long clip_mismatches = 0;
+        for (int i = 0; i < 20000; i++) {
+            int x1 = rand() % 3000 - 1100, y1 = rand() % 3000 - 1100;
+            int x2 = rand() % 3000 - 1100, y2 = rand() % 3000 - 1100;
+            PixelRecorder full, clipped;
+            clipped.rect = clip;
+            drawLine(full, algorithms[a], x1, y1, x2, y2);
+            drawLine(clipped, algorithms[a], x1, y1, x2, y2);
+
+            std::vector<std::pair<int, int>> expected;
+            for (const auto& p : full.pixels) {
+                if (computeOutCode(p.first, p.second, clip) == CLIP_INSIDE) {
+                    expected.push_back(p);
+                }
+            }
+            std::sort(expected.begin(), expected.end());
+            std::sort(clipped.pixels.begin(), clipped.pixels.end());
+            if (expected != clipped.pixels) {
+                clip_mismatches++;
+            }
+        }
+        std::cout << "Clipped " << names[a] << ": " << clip_mismatches << " of 20000 lines differ" << std::endl;
+        // The float DDA restarts its running sum at the clip edge, so it may
+        // legitimately differ by a rounding step; all others must be exact.
+        if (algorithms[a] != DrawAlgorithm::DDA) {
+            ok = ok && clip_mismatches == 0;
+        }
+    }
+
+    // 4) Wu: at every step the pixel pair must straddle the exact line, with
+    //    the second pixel's coverage the exact fraction in 1/256ths and the
+    //    two coverages adding up to a full pixel.
+    long wu_wrong = 0;
+    for (int i = 0; i < 20000; i++) {
+        int x1 = rand() % 2000 - 1000, y1 = rand() % 2000 - 1000;
+        int x2 = rand() % 2000 - 1000, y2 = rand() % 2000 - 1000;
+        PixelRecorder wu;
+        drawLineWu(wu, x1, y1, x2, y2);
+
+        bool steep = std::abs(y2 - y1) > std::abs(x2 - x1);
+        if (steep) {
+            std::swap(x1, y1);
+            std::swap(x2, y2);
+        }
+        if (x1 > x2) {
+            std::swap(x1, x2);
+            std::swap(y1, y2);
+        }
+        size_t k = 0;
+        for (int x = x1; x <= x2; x++) {
+            // Exact y = y1 + (x - x1) * dy / dx, split into floor and fraction
+            long long num = (long long)y1 * std::max(x2 - x1, 1) + (long long)(x - x1) * (y2 - y1);
+            long long den = std::max(x2 - x1, 1);
+            long long floor_y = num >= 0 ? num / den : -((-num + den - 1) / den);
+            int second = static_cast<int>((num - floor_y * den) * 256 / den);
+            int sum = 0;
+            for (; k < wu.pixels.size(); k++) {
+                int major = steep ? wu.pixels[k].second : wu.pixels[k].first;
+                int minor = steep ? wu.pixels[k].first : wu.pixels[k].second;
+                if (major != x) break;
+                int expected = (minor == floor_y) ? COVERAGE_FULL - second : (minor == floor_y + 1 ? second : -1);
+                if (wu.coverages[k] != expected) wu_wrong++;
+                sum += wu.coverages[k];
+            }
+            if (sum != COVERAGE_FULL) wu_wrong++;
+        }
+    }
+    std::cout << "Wu coverage vs exact line: " << wu_wrong << " errors in 20000 lines" << std::endl;
+    ok = ok && wu_wrong == 0;
+    return ok;
+}
+
+// --- Circles ---
+inline bool checkCircles() {
+    bool ok = true;
+
+    // 5) Filled discs: every row must run exactly between the outline's
+    //    outermost pixels in that row, with no pixel drawn twice. Rings
+    //    must be exactly the disc minus the disc of the inner radius.
+    long disc_wrong = 0, ring_wrong = 0;
+    for (int radius = 0; radius <= 400; radius++) {
+        PixelRecorder outline, disc;
+        traceCircleMidpoint(outline, 0, 0, radius);
+        fillDiscMidpoint(disc, 0, 0, radius);
+
+        std::vector<int> left(2 * radius + 1, radius + 1), right(2 * radius + 1, -radius - 1);
+        for (const auto& p : outline.pixels) {
+            left[p.second + radius] = std::min(left[p.second + radius], p.first);
+            right[p.second + radius] = std::max(right[p.second + radius], p.first);
+        }
+        std::vector<std::pair<int, int>> expected;
+        for (int y = -radius; y <= radius; y++) {
+            for (int x = left[y + radius]; x <= right[y + radius]; x++) {
+                expected.push_back({x, y});
+            }
+        }
+        std::sort(expected.begin(), expected.end());
+        std::sort(disc.pixels.begin(), disc.pixels.end());
+        if (disc.pixels != expected) {
+            disc_wrong++;
+        }
+
+        for (int inner : {1, radius / 3, radius / 2, radius - 1}) {
+            if (inner <= 0 || inner >= radius) {
+                continue;
+            }
+            PixelRecorder ring, hole;
+            fillRingMidpoint(ring, 0, 0, radius, inner);
+            fillDiscMidpoint(hole, 0, 0, inner);
+            std::sort(hole.pixels.begin(), hole.pixels.end());
+            std::vector<std::pair<int, int>> expected_ring;
+            std::set_difference(expected.begin(), expected.end(), hole.pixels.begin(), hole.pixels.end(),
+                                std::back_inserter(expected_ring));
+            std::sort(ring.pixels.begin(), ring.pixels.end());
+            if (ring.pixels != expected_ring) {
+                ring_wrong++;
+            }
+        }
+    }
+    std::cout << "Filled discs off the outline: " << disc_wrong << ", rings off disc minus hole: " << ring_wrong
+              << " (radius 0..400)" << std::endl;
+    ok = ok && disc_wrong == 0 && ring_wrong == 0;
+
+    // 6) Octant cache: the cached tables (compile-time ones for small radii,
+    //    runtime ones above) must draw exactly the midpoint outline. A small
+    //    budget forces evictions, which must keep it under that budget.
+    long cache_wrong = 0;
+    CircleOctantCache small_cache(2000);
+    for (int pass = 0; pass < 2; pass++) {
+        for (int radius = 0; radius <= 400; radius++) {
+            PixelRecorder direct, cached;
+            traceCircleMidpoint(direct, 3, -7, radius);
+            OctantTable octant = small_cache.lookup(radius);
+            drawCircleOctants(cached, 3, -7, octant.points, octant.count);
+            if (cached.pixels != direct.pixels) {
+                cache_wrong++;
+            }
+        }
+    }
+    CircleCacheStats cache_stats = small_cache.stats();
+    if (cache_stats.cached_points > 2000 || cache_stats.evictions == 0) {
+        cache_wrong++;
+    }
+    std::cout << "Octant cache vs midpoint walk: " << cache_wrong << " errors (radius 0..400, "
+              << cache_stats.evictions << " evictions)" << std::endl;
+    ok = ok && cache_wrong == 0;
+    return ok;
+}
+
+// --- Ellipses ---
+inline bool checkEllipses() {
+    // 7) Ellipses: filled midpoint ellipses must run between the outline's
+    //    outermost pixels in every row, like the discs above. Rotated
+    //    ellipses must step to exactly the pixels whose Q(x, y) <= 0.
+    long ellipse_wrong = 0, rotated_wrong = 0;
+    for (int rx = 0; rx <= 60; rx++) {
+        for (int ry = 0; ry <= 60; ry++) {
+            PixelRecorder outline, fill;
+            traceEllipseMidpoint(outline, 0, 0, rx, ry);
+            fillEllipseMidpoint(fill, 0, 0, rx, ry);
+            std::vector<int> left(2 * ry + 1, rx + 1), right(2 * ry + 1, -rx - 1);
+            for (const auto& p : outline.pixels) {
+                left[p.second + ry] = std::min(left[p.second + ry], p.first);
+                right[p.second + ry] = std::max(right[p.second + ry], p.first);
+            }
+            std::vector<std::pair<int, int>> expected;
+            for (int y = -ry; y <= ry; y++) {
+                for (int x = left[y + ry]; x <= right[y + ry]; x++) {
+                    expected.push_back({x, y});
+                }
+            }
+            std::sort(expected.begin(), expected.end());
+            std::sort(fill.pixels.begin(), fill.pixels.end());
+            if (fill.pixels != expected || right[ry] != rx) {
+                ellipse_wrong++;
+            }
+        }
+    }
+    for (int rx : {1, 2, 5, 17, 60, 250}) {
+        for (int ry : {1, 3, 9, 60, 400}) {
+            for (int angle = 1; angle < 360; angle += 7) {
+                EllipseConic q = rotatedEllipseConic(rx, ry, angle);
+                const int reach = std::max(rx, ry) + 2;
+                // Whole ellipses, and bands starting away from the center
+                for (int band_min : {-reach, -ry / 2, ry / 3}) {
+                    int band_max = band_min + (band_min == -reach ? 2 * reach : reach / 2);
+                    const RotatedEllipseRows& rows = rotatedEllipseRows(q, band_min, band_max);
+                    for (int y = band_min; y <= band_max; y++) {
+                        int first = INT_MAX, last = INT_MIN;
+                        for (int x = -reach; x <= reach; x++) {
+                            if (q.at(x, y) <= 0) {
+                                first = std::min(first, x);
+                                last = std::max(last, x);
+                            }
+                        }
+                        if (rows.has(y) ? (rows.at(y).left != first || rows.at(y).right != last) : first != INT_MAX) {
+                            rotated_wrong++;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    std::cout << "Filled ellipses off the outline: " << ellipse_wrong << " (0..60 x 0..60), rotated ellipse rows off Q <= 0: "
+              << rotated_wrong << std::endl;
+    return ellipse_wrong == 0 && rotated_wrong == 0;
+}
+
+// --- Polygons ---
+inline bool checkPolygons() {
+    // 8) Polygons: the scanline fill must draw exactly the pixel centers the
+    //    fill rule puts inside, found the slow way by counting crossings to
+    //    the left of each pixel, also when clipped to a band. Two triangles
+    //    sharing an edge must cover their quad with no pixel drawn twice.
+    long polygon_wrong = 0;
+    srand(19);
+    for (int iteration = 0; iteration < 400; iteration++) {
+        Polygon p;
+        for (int v = 3 + rand() % 12; v > 0; v--) {
+            p.x.push_back(rand() % 61 - 30);
+            p.y.push_back(rand() % 61 - 30);
+        }
+        p.rule = (iteration % 2) ? FillRule::NON_ZERO : FillRule::EVEN_ODD;
+        buildEdgeTable(p);
+        PixelRecorder fill;
+        fill.rect = (iteration % 3 == 0) ? ClipRect{-12, -7, 9, 11} : ClipRect{-40, -40, 40, 40};
+        fillPolygon(fill, p);
+        std::vector<std::pair<int, int>> expected;
+        for (int py = fill.rect.ymin; py <= fill.rect.ymax; py++) {
+            for (int px = fill.rect.xmin; px <= fill.rect.xmax; px++) {
+                int crossings = 0, winding = 0;
+                for (const PolygonEdge& e : p.edge_table) {
+                    // Crosses this scanline at or left of the pixel center?
+                    if (py >= e.y_top && py < e.y_bottom &&
+                        (long long)e.x_top * e.dy + (long long)e.dx * (py - e.y_top) <= (long long)px * e.dy) {
+                        crossings++;
+                        winding += e.winding;
+                    }
+                }
+                if (p.rule == FillRule::EVEN_ODD ? (crossings & 1) : winding != 0) {
+                    expected.push_back({px, py});
+                }
+            }
+        }
+        std::sort(fill.pixels.begin(), fill.pixels.end(), [](const std::pair<int, int>& a, const std::pair<int, int>& b) {
+            return a.second != b.second ? a.second < b.second : a.first < b.first;
+        });
+        if (fill.pixels != expected) {
+            polygon_wrong++;
+        }
+
+        // A random convex quad cut along one diagonal
+        Polygon quad, a, b;
+        quad.x = {rand() % 41 - 40, rand() % 41, rand() % 41, rand() % 41 - 40};
+        quad.y = {rand() % 41 - 40, rand() % 41 - 40, rand() % 41, rand() % 41};
+        bool convex = true;
+        for (int i = 0; i < 4; i++) {
+            int j = (i + 1) % 4, k = (i + 2) % 4;
+            long long turn = (long long)(quad.x[j] - quad.x[i]) * (quad.y[k] - quad.y[j]) -
+                             (long long)(quad.y[j] - quad.y[i]) * (quad.x[k] - quad.x[j]);
+            convex = convex && turn > 0;
+        }
+        if (!convex) {
+            continue;
+        }
+        a.x = {quad.x[0], quad.x[1], quad.x[2]};
+        a.y = {quad.y[0], quad.y[1], quad.y[2]};
+        b.x = {quad.x[0], quad.x[2], quad.x[3]};
+        b.y = {quad.y[0], quad.y[2], quad.y[3]};
+        buildEdgeTable(quad);
+        buildEdgeTable(a);
+        buildEdgeTable(b);
+        PixelRecorder whole, halves;
+        fillPolygon(whole, quad);
+        fillPolygon(halves, a);
+        fillPolygon(halves, b);
+        std::sort(whole.pixels.begin(), whole.pixels.end());
+        std::sort(halves.pixels.begin(), halves.pixels.end());
+        if (whole.pixels != halves.pixels) {
+            polygon_wrong++;
+        }
+    }
+    std::cout << "Polygon fills off the fill rule or split quads overlapping: " << polygon_wrong << std::endl;
+    return polygon_wrong == 0;
+}
+
+// --- Triangles ---
+inline bool checkTriangles() {
+    // 9) Triangles: the edge-function rasterizer must fill exactly the pixels
+    //    fillPolygon fills for the same three corners (same top-left rule),
+    //    for both windings, slivers and huge triangles past the guard band,
+    //    clipped to boxes that do or don't line up with its 8x8 blocks.
+    long triangle_wrong = 0;
+    srand(20);
+    for (int iteration = 0; iteration < 3000; iteration++) {
+        const int reach = (iteration % 10 == 9) ? 40000 : (iteration % 3 == 0) ? 300 : 40;
+        Polygon p;
+        for (int v = 0; v < 3; v++) {
+            p.x.push_back(rand() % (2 * reach + 1) - reach);
+            p.y.push_back(rand() % (2 * reach + 1) - reach);
+        }
+        if (iteration % 7 == 0) {
+            p.x[2] = (p.x[0] + p.x[1]) / 2 + rand() % 3 - 1; // A sliver
+            p.y[2] = (p.y[0] + p.y[1]) / 2 + rand() % 3 - 1;
+        }
+        buildEdgeTable(p);
+        PixelRecorder polygon, triangle;
+        int x0 = rand() % 61 - 30, y0 = rand() % 61 - 30;
+        polygon.rect = triangle.rect = {x0 - 45, y0 - 45, x0 + 45, y0 + 45};
+        fillPolygon(polygon, p);
+        fillTriangle(triangle, p.x[0], p.y[0], p.x[1], p.y[1], p.x[2], p.y[2]);
+        std::sort(polygon.pixels.begin(), polygon.pixels.end());
+        std::sort(triangle.pixels.begin(), triangle.pixels.end());
+        if (polygon.pixels != triangle.pixels) {
+            triangle_wrong++;
+        }
+    }
+    std::cout << "Triangles off the scanline polygon fill: " << triangle_wrong << " of 3000" << std::endl;
+    return triangle_wrong == 0;
+}
+
+// --- Depth Buffer ---
+inline bool checkDepth() {
+    // 10) Depth: with nothing in the way the depth-tested line draws exactly
+    //     Bresenham's pixels (also clipped, and across epoch wrap-arounds),
+    //     two crossing lines leave the same picture whichever goes first,
+    //     and with the cube's faces in the depth buffer the edges of the
+    //     faces we see are drawn whole and the back edges (almost) not at all.
+    long depth_wrong = 0, hidden_shown = 0;
+    DepthBuffer depth;
+    depth.resize(600, 600);
+    srand(21);
+    for (int iteration = 0; iteration < 600; iteration++) {
+        int x1 = rand() % 121 + 240, y1 = rand() % 121 + 240, x2 = rand() % 121 + 240, y2 = rand() % 121 + 240;
+        PixelRecorder plain, tested;
+        if (iteration % 2) {
+            plain.rect = tested.rect = {270, 280, 330, 310};
+        } else {
+            plain.rect = tested.rect = {0, 0, 599, 599};
+        }
+        depth.clear();
+        drawLineBresenham(plain, x1, y1, x2, y2);
+        drawLineDepth(tested, depth, x1, y1, rand() % DEPTH_MAX, x2, y2, rand() % DEPTH_MAX);
+        if (plain.pixels != tested.pixels) {
+            depth_wrong++;
+        }
+
+        // Crossing lines, one wholly nearer than the other
+        int near_z = rand() % 1000, far_z = 2000 + rand() % 1000;
+        int x3 = rand() % 121 + 240, y3 = rand() % 121 + 240, x4 = rand() % 121 + 240, y4 = rand() % 121 + 240;
+        std::vector<std::pair<int, int>> pictures[2];
+        for (int order = 0; order < 2; order++) {
+            PixelRecorder near_line, far_line;
+            depth.clear();
+            for (int k = 0; k < 2; k++) {
+                if ((k == 0) == (order == 0)) {
+                    drawLineDepth(near_line, depth, x1, y1, near_z, x2, y2, near_z + 500);
+                } else {
+                    drawLineDepth(far_line, depth, x3, y3, far_z + 500, x4, y4, far_z);
+                }
+            }
+            // What is left of the far line once the near one is on top
+            std::set<std::pair<int, int>> covered(near_line.pixels.begin(), near_line.pixels.end());
+            for (const auto& pixel : far_line.pixels) {
+                if (!covered.count(pixel)) {
+                    pictures[order].push_back(pixel);
+                }
+            }
+            std::sort(pictures[order].begin(), pictures[order].end());
+            pictures[order].erase(std::unique(pictures[order].begin(), pictures[order].end()), pictures[order].end());
+        }
+        if (pictures[0] != pictures[1]) {
+            depth_wrong++;
+        }
+    }
+    SceneMeshes meshes;
+    for (int pose = 0; pose < 48; pose++) {
+        meshes.transform({pose * 0.131f, 60.0f + pose * 10, 540.0f - pose * 9, 100, 100});
+        const ScreenVertices& v = meshes.cube_screen;
+        PixelRecorder drawn;
+        drawn.rect = {0, 0, 599, 599};
+        depth.clear();
+        writeTriangleDepth(depth, drawn.rect, v, cube_triangles);
+        drawEdgesDepth(drawn, depth, v, cube_edges);
+        std::set<std::pair<int, int>> hidden_lines(drawn.pixels.begin(), drawn.pixels.end()), front;
+        for (const auto& corners : cube_faces) {
+            long long area2 = 0;
+            for (size_t i = 0; i < corners.size(); i++) {
+                int a = corners[i], b = corners[(i + 1) % corners.size()];
+                area2 += (long long)v.x[a] * v.y[b] - (long long)v.x[b] * v.y[a];
+            }
+            for (size_t i = 0; i < corners.size() && area2 > 0; i++) {
+                int a = corners[i], b = corners[(i + 1) % corners.size()];
+                PixelRecorder edge;
+                edge.rect = drawn.rect;
+                drawLineBresenham(edge, v.x[a], v.y[a], v.x[b], v.y[b]);
+                front.insert(edge.pixels.begin(), edge.pixels.end());
+            }
+        }
+        for (const auto& pixel : front) {
+            depth_wrong += hidden_lines.count(pixel) ? 0 : 1; // A visible edge pixel went missing
+        }
+        for (const auto& pixel : hidden_lines) {
+            hidden_shown += front.count(pixel) ? 0 : 1;
+        }
+    }
+    std::cout << "Depth-tested lines off Bresenham or order-dependent: " << depth_wrong
+              << ", back edge pixels shown: " << hidden_shown << " (at most 2 per cube, where they meet a front edge)"
+              << std::endl;
+    return depth_wrong == 0 && hidden_shown <= 2 * 48;
+}
+
+// --- OBJ Loader ---
+inline bool checkObjLoader() {
+    // 11) OBJ loading: numbers must read like strtof's, and the cube written
+    //     as an .obj file (its faces in every index form, some relative,
+    //     among lines the loader skips) must come back with the cube's
+    //     corners, its 12 edges once each, and faces facing the same way.
+    long obj_wrong = 0;
+    srand(22);
+    for (int i = 0; i < 2000; i++) {
+        char text[64];
+        double value = (rand() % 2000001 - 1000000) * std::pow(10.0, rand() % 13 - 9);
+        snprintf(text, sizeof(text), i % 2 ? "%.6f" : "%.8e", value);
+        float parsed;
+        const char* end = parseObjFloat(text, text + strlen(text), parsed);
+        float expected = strtof(text, nullptr);
+        if (end != text + strlen(text) || std::abs(parsed - expected) > std::abs(expected) * 1e-6f) {
+            obj_wrong++;
+        }
+    }
+    const char* cube_obj = "# A cube\n"
+                           "mtllib cube.mtl\n"
+                           "o Cube\n"
+                           "v -1 1 -1\nv 1 1 -1\nv 1.0 -1.0 -1.0\nv -1 -1 -1\n"
+                           "v -1 1 1\nv 1 1 1\nv 1e0 -1e0 1e0\nv -1 -1 1 1.0\n"
+                           "vt 0 0\nvn 0 0 1\n\n"
+                           "usemtl Steel\ns off\n"
+                           "f 2 3 4 1\n"
+                           "f 8/8 7/7 6/6 5/5\n"
+                           "f 5/1/1 6/2/1 2/3/1 1/4/1\n"
+                           "  f 3//2 7//2 8//2 4//2\r\n"
+                           "f -5 -1 -4 -8\n"
+                           "f\t6 7 3 2";
+    ObjMesh obj;
+    std::string obj_error;
+    if (!parseObj(cube_obj, strlen(cube_obj), obj, obj_error) || obj.faces != 6 || obj.triangles.size() != 12) {
+        obj_wrong++;
+    } else {
+        fitObjMesh(obj, 40.0f);
+        for (size_t i = 0; i < cube_vertices.size(); i++) {
+            if (obj.vertices.x[i] != cube_vertices[i].x || obj.vertices.y[i] != cube_vertices[i].y ||
+                obj.vertices.z[i] != cube_vertices[i].z) {
+                obj_wrong++;
+            }
+        }
+        std::vector<std::pair<int, int>> expected_edges;
+        for (const auto& e : cube_edges) {
+            expected_edges.push_back({std::min(e.first, e.second), std::max(e.first, e.second)});
+        }
+        std::sort(expected_edges.begin(), expected_edges.end());
+        std::sort(obj.edges.begin(), obj.edges.end());
+        obj_wrong += obj.edges == expected_edges ? 0 : 1;
+        // Same corners, so the triangles we see must touch the same corners
+        SceneMeshes posed;
+        for (int pose = 0; pose < 16; pose++) {
+            posed.transform({0.3f + pose * 0.4f, 300, 300, 300, 300});
+            const ScreenVertices& v = posed.cube_screen;
+            std::set<int> front[2];
+            for (int mesh = 0; mesh < 2; mesh++) {
+                for (const auto& t : mesh ? obj.triangles : cube_triangles) {
+                    if ((long long)(v.x[t[1]] - v.x[t[0]]) * (v.y[t[2]] - v.y[t[0]]) >
+                        (long long)(v.y[t[1]] - v.y[t[0]]) * (v.x[t[2]] - v.x[t[0]])) {
+                        front[mesh].insert(t.begin(), t.end());
+                    }
+                }
+            }
+            obj_wrong += front[0] == front[1] && !front[0].empty() ? 0 : 1;
+        }
+    }
+    const char* broken[] = {"v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 4\n", "v 0 0 0\nf 1 -2 1\n", "v 0 0\n",
+                            "v 0 0 0\nv 1 0 0\nf 1 2\n", "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 0 2\n",
+                            "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 x 3\n", "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 -\n"};
+    for (const char* text : broken) {
+        obj_wrong += parseObj(text, strlen(text), obj, obj_error) ? 1 : 0; // Must be refused
+    }
+    // A comment after a face's corners is not one more corner
+    const char* commented = "v 0 0 0 # origin\nv 1 0 0\nv 0 1 0\nf 1 2 3 # the only face\n";
+    obj_wrong += parseObj(commented, strlen(commented), obj, obj_error) && obj.triangles.size() == 1 ? 0 : 1;
+    // Numbers too long for a long must not overflow it: the index is
+    // refused and the exponents saturate, like strtof's
+    const char* huge_index = "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 99999999999999999999999999\n";
+    obj_wrong += parseObj(huge_index, strlen(huge_index), obj, obj_error) ||
+                 obj_error.find("bad vertex index") == std::string::npos;
+    for (const char* text : {"1e99999999999999999999999999", "-1e99999999999999999999999999",
+                             "1e-99999999999999999999999999"}) {
+        float parsed;
+        const char* end = parseObjFloat(text, text + strlen(text), parsed);
+        obj_wrong += end != text + strlen(text) || parsed != strtof(text, nullptr);
+    }
+    std::cout << "OBJ numbers or cube off: " << obj_wrong << std::endl;
+    return obj_wrong == 0;
+}
+
+// --- Edge Builder ---
+inline bool checkEdgeBuilder() {
+    // 12) Edge builder: random triangle and quad meshes (with repeated and
+    //     degenerate corners) must give exactly the edges a std::set of
+    //     (lower, higher) pairs gives, each once, in any index type; sorted,
+    //     in the set's order. The cube's faces must give the cube's edges, and
+    //     corners too big for the index type must be refused.
+    long edge_wrong = 0;
+    srand(23);
+    for (int mesh = 0; mesh < 200; mesh++) {
+        const int vertex_count = 1 + rand() % (mesh % 2 ? 30 : 3000);
+        std::vector<std::array<int, 3>> triangles(rand() % 500);
+        std::vector<std::array<int, 4>> quads(rand() % 500);
+        std::set<std::pair<int, int>> expected;
+        auto remember = [&](const int* corners, int n) {
+            for (int i = 0; i < n; i++) {
+                int a = corners[i], b = corners[(i + 1) % n];
+                if (a != b) {
+                    expected.insert({std::min(a, b), std::max(a, b)});
+                }
+            }
+        };
+        for (auto& t : triangles) {
+            for (int& corner : t) {
+                corner = rand() % vertex_count;
+            }
+            remember(t.data(), 3);
+        }
+        for (auto& q : quads) {
+            for (int& corner : q) {
+                corner = rand() % vertex_count;
+            }
+            remember(q.data(), 4);
+        }
+        EdgeSet<int> both;
+        for (const auto& t : triangles) {
+            both.addFace(t.data(), 3);
+        }
+        for (const auto& q : quads) {
+            both.addFace(q.data(), 4);
+        }
+        std::vector<std::pair<int, int>> unsorted = both.edges, sorted = both.take(true);
+        std::vector<std::pair<int, int>> want(expected.begin(), expected.end());
+        edge_wrong += sorted == want ? 0 : 1;
+        std::sort(unsorted.begin(), unsorted.end());
+        edge_wrong += unsorted == want ? 0 : 1;
+        // Triangles alone, through EdgeBuilder, in 16-bit indices
+        std::set<std::pair<int, int>> from_triangles;
+        for (const auto& t : triangles) {
+            for (int i = 0; i < 3; i++) {
+                if (t[i] != t[(i + 1) % 3]) {
+                    from_triangles.insert({std::min(t[i], t[(i + 1) % 3]), std::max(t[i], t[(i + 1) % 3])});
+                }
+            }
+        }
+        std::vector<std::pair<uint16_t, uint16_t>> small = EdgeBuilder::fromFaces<uint16_t>(triangles, true);
+        edge_wrong += small.size() == from_triangles.size() &&
+                      std::equal(small.begin(), small.end(), from_triangles.begin(),
+                                 [](const std::pair<uint16_t, uint16_t>& a, const std::pair<int, int>& b) {
+                                     return a.first == b.first && a.second == b.second;
+                                 })
+                          ? 0 : 1;
+    }
+    std::set<std::pair<int, int>> cube_set;
+    for (const auto& e : cube_edges) {
+        cube_set.insert({std::min(e.first, e.second), std::max(e.first, e.second)});
+    }
+    std::vector<std::pair<int, int>> built = EdgeBuilder::fromFaces(cube_faces, true);
+    edge_wrong += built == std::vector<std::pair<int, int>>(cube_set.begin(), cube_set.end()) ? 0 : 1;
+    // A corner past 65535 must be refused in 16-bit indices, not wrapped
+    // around onto vertex 4464; in int indices it is fine
+    const std::vector<std::array<int, 3>> big = {{0, 1, 2}, {1, 70000, 2}};
+    EdgeSet<uint16_t> narrow;
+    edge_wrong += narrow.addFace(big[1].data(), 3) || !narrow.edges.empty() ||
+                  !narrow.addFace(big[0].data(), 3);
+    edge_wrong += EdgeBuilder::fromFaces<uint16_t>(big).empty() && EdgeBuilder::fromFaces(big).size() == 5 ? 0 : 1;
+    std::cout << "Edge builder meshes off a std::set: " << edge_wrong << " of 201" << std::endl;
+    return edge_wrong == 0;
+}
+
+// --- Instances ---
+inline bool checkInstances() {
+    // 13) Instances: the SIMD step must move, bounce and turn each cube like
+    //     the plain formulas do, keep its rotation a rotation over many
+    //     steps, and the placed and projected corners must land (within a
+    //     pixel) where objectModelMatrix and transformVertices put them.
+    long instance_wrong = 0;
+    SceneMeshes stress;
+    stress.spawnInstances(1003, 24); // Not a multiple of 8, so the one-at-a-time loop runs too
+    CubeInstances reference = stress.instances;
+    for (int step = 0; step < 3000; step++) {
+        stress.instances.step();
+        for (size_t i = 0; i < reference.size(); i++) {
+            CubeInstances& r = reference;
+            r.x[i] += r.dx[i];
+            r.y[i] += r.dy[i];
+            r.dx[i] = r.x[i] <= r.min_x ? std::abs(r.dx[i]) : r.x[i] >= r.max_x ? -std::abs(r.dx[i]) : r.dx[i];
+            r.dy[i] = r.y[i] <= r.min_y ? std::abs(r.dy[i]) : r.y[i] >= r.max_y ? -std::abs(r.dy[i]) : r.dy[i];
+            double angle = std::atan2(r.sin_angle[i], r.cos_angle[i]) + std::atan2(r.sin_spin[i], r.cos_spin[i]);
+            r.cos_angle[i] = static_cast<float>(std::cos(angle));
+            r.sin_angle[i] = static_cast<float>(std::sin(angle));
+        }
+    }
+    for (size_t i = 0; i < reference.size(); i++) {
+        const CubeInstances &a = stress.instances, &r = reference;
+        bool moved = a.x[i] == r.x[i] && a.y[i] == r.y[i] && a.dx[i] == r.dx[i] && a.dy[i] == r.dy[i];
+        bool turned = std::abs(a.cos_angle[i] - r.cos_angle[i]) < 1e-3f && std::abs(a.sin_angle[i] - r.sin_angle[i]) < 1e-3f;
+        instance_wrong += moved && turned ? 0 : 1;
+    }
+    stress.transform({0, 300, 300, 300, 300});
+    ScreenVertices one;
+    for (size_t i = 0; i < stress.instances.size(); i++) {
+        const CubeInstances& a = stress.instances;
+        float angle = std::atan2(a.sin_angle[i], a.cos_angle[i]);
+        transformVertices(stress.cube, stress.view_projection * objectModelMatrix(angle, a.x[i], a.y[i]),
+                          stress.viewport, one);
+        for (size_t k = 0; k < one.x.size(); k++) {
+            size_t v = k * a.size() + i;
+            if (std::abs(one.x[k] - stress.instances_screen.x[v]) > 1 ||
+                std::abs(one.y[k] - stress.instances_screen.y[v]) > 1) {
+                instance_wrong++;
+            }
+        }
+    }
+    std::cout << "Instanced cubes off the plain step or projection: " << instance_wrong << std::endl;
+    return instance_wrong == 0;
+}
+
+// --- Collisions ---
+inline bool checkCollisions() {
+    // 14) Collisions: with any cell size (smaller or larger than the cubes)
+    //     the spatial hash must offer every pair of cubes that touch, each
+    //     pair once, and two cubes meeting head-on must swap velocities.
+    long collision_wrong = 0;
+    CubeInstances crowd;
+    crowd.spawn(3000, 25);
+    for (size_t i = 0; i < crowd.size(); i += 3) {
+        crowd.x[i] = 300 + (crowd.x[i] - 300) * 0.3f; // A dense clump in the middle
+        crowd.y[i] = 300 + (crowd.y[i] - 300) * 0.3f;
+    }
+    const float reach = 2 * COLLISION_RADIUS;
+    std::set<std::pair<uint32_t, uint32_t>> touching;
+    for (uint32_t i = 0; i < crowd.size(); i++) {
+        for (uint32_t j = i + 1; j < crowd.size(); j++) {
+            float dx = crowd.x[j] - crowd.x[i], dy = crowd.y[j] - crowd.y[i];
+            if (dx * dx + dy * dy < reach * reach) {
+                touching.insert({i, j});
+            }
+        }
+    }
+    for (float cell_size : {7.0f, 17.0f, 40.0f, 100.0f}) {
+        SpatialHash grid;
+        grid.cell_size = cell_size;
+        grid.build(crowd.x.data(), crowd.y.data(), crowd.size());
+        std::vector<std::pair<uint32_t, uint32_t>> candidates;
+        grid.candidates(0, crowd.size(), reach, candidates);
+        std::set<std::pair<uint32_t, uint32_t>> offered(candidates.begin(), candidates.end()), found;
+        collision_wrong += offered.size() == candidates.size() ? 0 : 1; // No pair twice
+        for (const auto& p : offered) {
+            float dx = crowd.x[p.second] - crowd.x[p.first], dy = crowd.y[p.second] - crowd.y[p.first];
+            if (dx * dx + dy * dy < reach * reach) {
+                found.insert(p);
+            }
+        }
+        collision_wrong += found == touching ? 0 : 1;
+    }
+    CubeInstances pair;
+    pair.spawn(2, 26);
+    pair.x = {200, 230};
+    pair.y = {300, 300};
+    pair.dx = {1.5f, -0.5f};
+    pair.dy = {0, 0};
+    InstanceCollisions collider;
+    collider.resolve(pair);
+    // Within rounding: with FMA (-march=native) the bounce rounds once less
+    collision_wrong += std::abs(pair.dx[0] + 0.5f) < 1e-5f && std::abs(pair.dx[1] - 1.5f) < 1e-5f &&
+                       collider.stats.contacts == 1 ? 0 : 1;
+    std::cout << "Spatial hash cell sizes missing or repeating a contact: " << collision_wrong << " (" << touching.size()
+              << " contacts)" << std::endl;
+    return collision_wrong == 0;
+}
+
+// Runs every check above, even after one fails, and returns the exit code.
+inline int runChecks() {
+    bool (*const checks[])() = {checkLines, checkCircles,   checkEllipses,    checkPolygons,  checkTriangles,
+                                checkDepth, checkObjLoader, checkEdgeBuilder, checkInstances, checkCollisions};
+    bool ok = true;
+    for (auto check : checks) {
+        ok = check() && ok;
+    }
+    std::cout << (ok ? "All self-checks passed" : "Self-checks FAILED") << std::endl;
+    return ok ? 0 : 1;
+}
+
+#endif // CHECKS_H
@@ -0,0 +1,215 @@
+// --- Circle Octant Cache ---
+// The midpoint walk for a given radius always produces the same octant
+// points, wherever the circle is. Users draw lots of circles with the same
+// radii, so the points are kept per radius and drawing a circle becomes a
+// walk over a table plus a translation (drawCircleOctants in Circles.h).
+//
+//   - Radii up to SMALL_RADIUS_MAX come from tables generated at compile
+//     time (constexpr), so they never miss and need no lock.
+//   - Larger radii are computed on first use and kept in an LRU cache with
+//     a bounded number of points; the least recently used radii are evicted
+//     first once the budget is full.
+//
+// The cache is shared by all threads (the tiled renderer draws circles on
+// several), so the large-radius part is behind a reader-writer lock. A hit
+// only reads the table, so the threads share the lock and hit in parallel;
+// each entry's last use is an atomic stamp rather than a place in a list,
+// so marking it recent needs no exclusive lock. Only a miss takes the lock
+// for itself, to insert (and evict), after walking the circle outside it.
+// Tables are handed out as shared_ptr, so evicting a radius never pulls a
+// table out from under a thread that is still drawing with it.
+#ifndef CIRCLE_CACHE_H
+#define CIRCLE_CACHE_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+struct OctantPoint {
+    int x, y;
+};
+
+// The octant walk of traceCircleMidpoint (Circles.h), calling visit(x, y)
+// for every point. constexpr, so it can also build the compile-time tables.
+template <typename Visit>
+constexpr void walkCircleOctant(int radius, Visit visit) {
+    int x = 0;
+    int y = radius;
+    int P = 1 - radius;
+    visit(x, y);
+    while (x < y) {
+        x++;
+        if (P < 0) {
+            P = P + (2 * x) + 1;
+        } else {
+            y--;
+            P = P + (2 * x) + 1 - (2 * y);
+        }
+        visit(x, y);
+    }
+}
+
+constexpr int octantPointCount(int radius) {
+    int count = 0;
+    walkCircleOctant(radius, [&](int, int) { count++; });
+    return count;
+}
+
+// --- Compile-Time Tables for Small Radii ---
+const int SMALL_RADIUS_MAX = 64;
+
+constexpr int smallOctantTotal() {
+    int total = 0;
+    for (int r = 0; r <= SMALL_RADIUS_MAX; r++) {
+        total += octantPointCount(r);
+    }
+    return total;
+}
+
+// All small radii back to back: radius r owns points[start[r]] up to points[start[r + 1]].
+struct SmallOctantTables {
+    int start[SMALL_RADIUS_MAX + 2];
+    OctantPoint points[smallOctantTotal()];
+};
+
+constexpr SmallOctantTables makeSmallOctantTables() {
+    SmallOctantTables tables{};
+    int next = 0;
+    for (int r = 0; r <= SMALL_RADIUS_MAX; r++) {
+        tables.start[r] = next;
+        walkCircleOctant(r, [&](int x, int y) { tables.points[next++] = {x, y}; });
+    }
+    tables.start[SMALL_RADIUS_MAX + 1] = next;
+    return tables;
+}
+
+inline constexpr SmallOctantTables SMALL_OCTANT_TABLES = makeSmallOctantTables();
+
+// --- Runtime Cache for Larger Radii ---
+struct CircleCacheStats {
+    unsigned long long hits = 0;      // Including the compile-time tables
+    unsigned long long misses = 0;
+    unsigned long long evictions = 0;
+    size_t cached_radii = 0;
+    size_t cached_points = 0;
+
+    double hitRate() const {
+        unsigned long long lookups = hits + misses;
+        return lookups ? 100.0 * hits / lookups : 0.0;
+    }
+};
+
+// A radius' octant points. "table" keeps cached points alive while in use.
+struct OctantTable {
+    const OctantPoint* points = nullptr;
+    int count = 0;
+    std::shared_ptr<const std::vector<OctantPoint>> table;
+};
+
+struct CircleOctantCache {
+    using Points = std::vector<OctantPoint>;
+
+    size_t max_points; // Memory budget, in points across all cached radii
+    std::atomic<bool> enabled{true};
+
+    std::shared_mutex mutex; // Shared for hits, exclusive to insert or evict
+    struct Entry {
+        std::shared_ptr<const Points> points;
+        std::atomic<unsigned long long> last_used{0}; // Stamp from "clock"; the lowest is evicted first
+    };
+    std::unordered_map<int, Entry> entries;
+    size_t cached_points = 0;
+    std::atomic<unsigned long long> clock{0};
+    std::atomic<unsigned long long> small_hits{0}, hits{0};
+    unsigned long long misses = 0, evictions = 0; // Only changed under the exclusive lock
+
+    explicit CircleOctantCache(size_t point_budget = 1 << 20) : max_points(point_budget) {}
+
+    // Returns an empty table when the cache is off, so the caller walks the
+    // circle itself.
+    OctantTable lookup(int radius) {
+        OctantTable result;
+        if (!enabled || radius < 0) {
+            return result;
+        }
+        if (radius <= SMALL_RADIUS_MAX) {
+            small_hits.fetch_add(1, std::memory_order_relaxed);
+            result.points = SMALL_OCTANT_TABLES.points + SMALL_OCTANT_TABLES.start[radius];
+            result.count = SMALL_OCTANT_TABLES.start[radius + 1] - SMALL_OCTANT_TABLES.start[radius];
+            return result;
+        }
+
+        {
+            std::shared_lock<std::shared_mutex> lock(mutex);
+            auto found = entries.find(radius);
+            if (found != entries.end()) {
+                hits.fetch_add(1, std::memory_order_relaxed);
+                found->second.last_used.store(clock.fetch_add(1, std::memory_order_relaxed) + 1,
+                                              std::memory_order_relaxed); // Now the most recent
+                result.table = found->second.points;
+            }
+        }
+        if (!result.table) {
+            // Walk the circle without holding the lock, so hits go on meanwhile
+            auto points = std::make_shared<Points>();
+            points->reserve(octantPointCount(radius));
+            walkCircleOctant(radius, [&](int x, int y) { points->push_back({x, y}); });
+            result.table = points;
+
+            std::unique_lock<std::shared_mutex> lock(mutex);
+            misses++;
+            // Another thread may have added it meanwhile; a radius bigger
+            // than the whole budget is used once and not kept
+            if (entries.count(radius) == 0 && points->size() <= max_points) {
+                while (cached_points + points->size() > max_points) {
+                    evictLeastRecent();
+                }
+                Entry& entry = entries[radius];
+                entry.points = points;
+                entry.last_used.store(clock.fetch_add(1, std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                cached_points += points->size();
+            }
+        }
+        result.points = result.table->data();
+        result.count = static_cast<int>(result.table->size());
+        return result;
+    }
+
+    // Under the exclusive lock. A scan for the oldest stamp: evictions are
+    // rare next to hits, which this keeps free of any shared list.
+    void evictLeastRecent() {
+        auto oldest = entries.begin();
+        for (auto it = entries.begin(); it != entries.end(); ++it) {
+            if (it->second.last_used.load(std::memory_order_relaxed) <
+                oldest->second.last_used.load(std::memory_order_relaxed)) {
+                oldest = it;
+            }
+        }
+        cached_points -= oldest->second.points->size();
+        entries.erase(oldest);
+        evictions++;
+    }
+
+    CircleCacheStats stats() {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        CircleCacheStats s;
+        s.hits = hits.load(std::memory_order_relaxed) + small_hits.load(std::memory_order_relaxed);
+        s.misses = misses;
+        s.evictions = evictions;
+        s.cached_radii = entries.size();
+        s.cached_points = cached_points;
+        return s;
+    }
+};
+
+// The cache every drawCircle call goes through.
+inline CircleOctantCache& circleOctantCache() {
+    static CircleOctantCache cache;
+    return cache;
+}
+
+#endif // CIRCLE_CACHE_H
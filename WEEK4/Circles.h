@@ -0,0 +1,226 @@
+// --- Circle Rasterizers ---
+#ifndef CIRCLES_H
+#define CIRCLES_H
+
+#include <algorithm>
+#include <vector>
+#include "CircleCache.h"
+#include "Clip.h"
+#include "Framebuffer.h" // ClippedTarget
+
+// How a circle is drawn, toggled with O in CIRCLE mode.
+enum class CircleStyle {
+    OUTLINE,
+    FILLED, // A solid disc
+    RING    // A thick ring: the disc minus a smaller disc of inner_radius
+};
+
+struct Circle {
+    int cx, cy, radius;
+    CircleStyle style = CircleStyle::OUTLINE;
+    int inner_radius = 0; // Only for RING
+};
+
+// --- WEEK 4: 8-Way Symmetry Pixel Plotter ---
+// This is a helper function for our circle algorithm.
+// It takes one point (x, y) relative to the center (cx, cy)
+// and draws all 8 symmetrical points of the circle.
+template <typename Target>
+void drawCirclePixels(Target& target, int cx, int cy, int x, int y) {
+    target.plot(cx + x, cy + y);
+    target.plot(cx - x, cy + y);
+    target.plot(cx + x, cy - y);
+    target.plot(cx - x, cy - y);
+    target.plot(cx + y, cy + x);
+    target.plot(cx - y, cy + x);
+    target.plot(cx + y, cy - x);
+    target.plot(cx - y, cy - x);
+}
+
+// --- WEEK 4: Midpoint Circle Algorithm (Bresenham's) ---
+// This function calculates the points for one octant (45 degrees)
+// and uses the drawCirclePixels helper to draw all 8 octants.
+template <typename Target>
+void traceCircleMidpoint(Target& target, int centerX, int centerY, int radius) {
+    int x = 0;
+    int y = radius;
+
+    // This is the initial "decision parameter" or "error term".
+    // It's derived from the circle equation for the first midpoint.
+    int P = 1 - radius;
+
+    // Call the helper to draw the first set of points
+    // (e.g., (0, r), (0, -r), (r, 0), (-r, 0))
+    drawCirclePixels(target, centerX, centerY, x, y);
+
+    // Loop until we've completed the first 45-degree octant
+    // (which is when x becomes greater than y)
+    while (x < y) {
+        x++; // Always step one pixel to the right
+
+        // --- This is the integer-only midpoint test ---
+        if (P < 0) {
+            // Midpoint is inside the circle.
+            // Choose the "East" (E) pixel: (x+1, y)
+            // Update the decision parameter for the next step.
+            P = P + (2 * x) + 1;
+        } else {
+            // Midpoint is outside or on the circle.
+            // Choose the "South-East" (SE) pixel: (x+1, y-1)
+            y--; // Move one pixel down
+            // Update the decision parameter for the next step.
+            P = P + (2 * x) + 1 - (2 * y);
+        }
+
+        // We have our new (x, y) for this octant.
+        // Call the helper to draw all 8 symmetric points.
+        drawCirclePixels(target, centerX, centerY, x, y);
+    }
+}
+
+// --- Filled Discs from the Midpoint Algorithm ---
+// The same octant walk as traceCircleMidpoint, but instead of 8 pixels per
+// step it reports whole rows: rowSpan(k, half_width) is called exactly once
+// for every row offset k = 0..radius, and rows centerY + k and centerY - k
+// both run from centerX - half_width to centerX + half_width. Each row ends
+// exactly on the outline pixel traceCircleMidpoint would draw there.
+//
+// The walk produces two kinds of rows. Row x (the steep octant) is widest
+// at the current y and gets reported right away. Row y (the flat octant)
+// keeps growing while x steps along it, so it is only reported when y is
+// about to move down, with the last x. Near the diagonal a row can be both;
+// the steep octant's width is then the larger one, so the flat row is
+// skipped.
+template <typename RowSpan>
+void traceDiscRows(int radius, RowSpan rowSpan) {
+    int x = 0;
+    int y = radius;
+    int P = 1 - radius; // Same decision parameter as traceCircleMidpoint
+
+    rowSpan(0, y);
+    while (x < y) {
+        int previous_y = y;
+        x++;
+        if (P < 0) {
+            P = P + (2 * x) + 1;
+        } else {
+            y--;
+            P = P + (2 * x) + 1 - (2 * y);
+        }
+        // Row previous_y is finished: its last pixel was at x - 1
+        if (y != previous_y && previous_y > x) {
+            rowSpan(previous_y, x - 1);
+        }
+        rowSpan(x, y);
+    }
+}
+
+// One horizontal span per scanline; the target fills each span in one go
+// (the framebuffer with std::fill_n, which the compiler vectorizes).
+template <typename Target>
+void fillDiscMidpoint(Target& target, int centerX, int centerY, int radius) {
+    traceDiscRows(radius, [&](int k, int half_width) {
+        target.hspan(centerX - half_width, centerX + half_width, centerY + k);
+        if (k != 0) {
+            target.hspan(centerX - half_width, centerX + half_width, centerY - k);
+        }
+    });
+}
+
+// A ring is the disc of "radius" minus the disc of "inner_radius": rows that
+// cross the hole become a left and a right span. The hole's row widths are
+// traced first into a buffer that is reused, so drawing does not allocate
+// once it has grown to the largest ring.
+template <typename Target>
+void fillRingMidpoint(Target& target, int centerX, int centerY, int radius, int inner_radius) {
+    if (inner_radius <= 0 || inner_radius >= radius) {
+        fillDiscMidpoint(target, centerX, centerY, radius);
+        return;
+    }
+    thread_local std::vector<int> hole_width; // Per row offset (tiles draw rings on several threads)
+    hole_width.resize(inner_radius + 1);
+    traceDiscRows(inner_radius, [&](int k, int half_width) { hole_width[k] = half_width; });
+
+    auto row = [&](int y, int half_width, int hole) {
+        if (hole < half_width) {
+            target.hspan(centerX - half_width, centerX - hole - 1, y);
+            target.hspan(centerX + hole + 1, centerX + half_width, y);
+        }
+    };
+    traceDiscRows(radius, [&](int k, int half_width) {
+        if (k > inner_radius) {
+            target.hspan(centerX - half_width, centerX + half_width, centerY + k);
+            target.hspan(centerX - half_width, centerX + half_width, centerY - k);
+        } else {
+            row(centerY + k, half_width, hole_width[k]);
+            if (k != 0) {
+                row(centerY - k, half_width, hole_width[k]);
+            }
+        }
+    });
+}
+
+// Clips a shape as a whole, given a rectangle it stays inside: off-screen
+// shapes are skipped, shapes fully on screen draw straight into the target,
+// and only shapes crossing the edge pay for a per-pixel (or per-span) check.
+template <typename Target, typename Draw>
+void drawClippedBounds(Target& target, const ClipRect& bounds, Draw draw) {
+    const ClipRect rect = target.clipRect();
+    if (bounds.xmax < rect.xmin || bounds.xmin > rect.xmax || bounds.ymax < rect.ymin || bounds.ymin > rect.ymax) {
+        return;
+    }
+    if (bounds.xmin >= rect.xmin && bounds.xmax <= rect.xmax && bounds.ymin >= rect.ymin && bounds.ymax <= rect.ymax) {
+        draw(target);
+    } else {
+        ClippedTarget<Target> clipped = {target, rect};
+        draw(clipped);
+    }
+}
+
+template <typename Target, typename Draw>
+void drawClippedCircle(Target& target, int centerX, int centerY, int radius, Draw draw) {
+    drawClippedBounds(target, {centerX - radius, centerY - radius, centerX + radius, centerY + radius}, draw);
+}
+
+template <typename Target>
+void drawCircleMidpoint(Target& target, int centerX, int centerY, int radius) {
+    drawClippedCircle(target, centerX, centerY, radius,
+                      [&](auto& t) { traceCircleMidpoint(t, centerX, centerY, radius); });
+}
+
+// --- Outline from the Octant Cache ---
+// The same pixels as traceCircleMidpoint, but the octant points come from
+// a table (CircleCache.h), so drawing is only the 8-way translation.
+template <typename Target>
+void drawCircleOctants(Target& target, int centerX, int centerY, const OctantPoint* points, int count) {
+    for (int i = 0; i < count; i++) {
+        drawCirclePixels(target, centerX, centerY, points[i].x, points[i].y);
+    }
+}
+
+template <typename Target>
+void drawCircleCached(Target& target, int centerX, int centerY, int radius) {
+    OctantTable octant = circleOctantCache().lookup(radius);
+    if (octant.count == 0) { // Cache turned off
+        drawCircleMidpoint(target, centerX, centerY, radius);
+        return;
+    }
+    drawClippedCircle(target, centerX, centerY, radius,
+                      [&](auto& t) { drawCircleOctants(t, centerX, centerY, octant.points, octant.count); });
+}
+
+// Draws a circle in its own style.
+template <typename Target>
+void drawCircle(Target& target, const Circle& c) {
+    if (c.style == CircleStyle::FILLED) {
+        drawClippedCircle(target, c.cx, c.cy, c.radius,
+                          [&](auto& t) { fillDiscMidpoint(t, c.cx, c.cy, c.radius); });
+    } else if (c.style == CircleStyle::RING) {
+        drawClippedCircle(target, c.cx, c.cy, c.radius,
+                          [&](auto& t) { fillRingMidpoint(t, c.cx, c.cy, c.radius, c.inner_radius); });
+    } else {
+        drawCircleCached(target, c.cx, c.cy, c.radius);
+    }
+}
+
+#endif // CIRCLES_H
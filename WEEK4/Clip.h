@@ -0,0 +1,168 @@
+#ifndef CLIP_H
+#define CLIP_H
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+// --- Line Clipping Stage ---
+// Shared by the X11 demo (PixelManipulationV4.cpp) and the image line
+// drawer (WEEK2/UseImg/BFL.cpp).
+//
+// The goal is to trim a line to the visible rectangle *before* rasterizing
+// it, so the per-pixel bounds check can go away. Simply moving the end
+// points onto the rectangle edge would change the slope the rasterizer sees
+// and therefore which pixels it picks, so we clip in "step space" instead:
+// we find the range of steps [first, last] along the line's major axis whose
+// pixels land inside the rectangle, and the rasterizer then runs only those
+// steps, starting with exactly the state it would have had there anyway.
+//
+//   1. Cohen-Sutherland outcodes trivially accept or reject the whole line.
+//   2. Liang-Barsky narrows the step range on the real line (with a 1 pixel
+//      margin, since a rasterized pixel is never more than half a pixel away).
+//   3. A binary search over the rasterizer's own pixel positions finds the
+//      exact first and last step inside the rectangle.
+
+// Inclusive pixel bounds.
+struct ClipRect {
+    int xmin, ymin, xmax, ymax;
+};
+
+// --- Cohen-Sutherland Outcodes ---
+const int CLIP_INSIDE = 0;
+const int CLIP_LEFT   = 1;
+const int CLIP_RIGHT  = 2;
+const int CLIP_TOP    = 4; // Smaller y (screen coordinates grow downwards)
+const int CLIP_BOTTOM = 8;
+
+inline int computeOutCode(int x, int y, const ClipRect& r) {
+    int code = CLIP_INSIDE;
+    if (x < r.xmin) {
+        code |= CLIP_LEFT;
+    } else if (x > r.xmax) {
+        code |= CLIP_RIGHT;
+    }
+    if (y < r.ymin) {
+        code |= CLIP_TOP;
+    } else if (y > r.ymax) {
+        code |= CLIP_BOTTOM;
+    }
+    return code;
+}
+
+// --- Liang-Barsky ---
+// Clips the segment P(t) = (x1, y1) + t * (x2 - x1, y2 - y1), t in [0, 1],
+// against [xmin, xmax] x [ymin, ymax]. On success t0/t1 bound the visible part.
+inline bool clipLiangBarsky(double x1, double y1, double x2, double y2,
+                            double xmin, double ymin, double xmax, double ymax,
+                            double& t0, double& t1) {
+    const double dx = x2 - x1;
+    const double dy = y2 - y1;
+    // One (p, q) pair per edge: the segment is inside that edge where p * t <= q.
+    const double p[4] = {-dx, dx, -dy, dy};
+    const double q[4] = {x1 - xmin, xmax - x1, y1 - ymin, ymax - y1};
+
+    t0 = 0.0;
+    t1 = 1.0;
+    for (int i = 0; i < 4; i++) {
+        if (p[i] == 0.0) {
+            // Parallel to this edge: either fully outside it or never crosses it.
+            if (q[i] < 0.0) {
+                return false;
+            }
+        } else {
+            double t = q[i] / p[i];
+            if (p[i] < 0.0) {
+                t0 = std::max(t0, t); // Entering
+            } else {
+                t1 = std::min(t1, t); // Leaving
+            }
+            if (t0 > t1) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// --- Clipping a Rasterized Line ---
+// pixelAt(i) must return the pixel (x, y) the rasterizer plots at step i,
+// for i in [0, steps]. Along a line both coordinates only ever move in one
+// direction, which is what makes the binary search below valid.
+// Returns false if no pixel is inside; otherwise [first, last] is the range
+// of steps to draw.
+template <typename PixelAt>
+bool clipLineSteps(const ClipRect& r, int steps, PixelAt pixelAt, int& first, int& last) {
+    const std::pair<int, int> start = pixelAt(0);
+    const std::pair<int, int> end = pixelAt(steps);
+
+    // 1) Cohen-Sutherland trivial accept / reject.
+    const int code_start = computeOutCode(start.first, start.second, r);
+    const int code_end = computeOutCode(end.first, end.second, r);
+    if ((code_start | code_end) == 0) {
+        first = 0;
+        last = steps;
+        return true;
+    }
+    if ((code_start & code_end) != 0) {
+        return false;
+    }
+
+    // 2) Liang-Barsky on the rectangle grown by one pixel gives a step range
+    //    that surely contains every visible pixel.
+    double t0, t1;
+    if (!clipLiangBarsky(start.first, start.second, end.first, end.second,
+                         r.xmin - 1.0, r.ymin - 1.0, r.xmax + 1.0, r.ymax + 1.0, t0, t1)) {
+        return false;
+    }
+    int lo = std::max(0, static_cast<int>(std::floor(t0 * steps)) - 1);
+    int hi = std::min(steps, static_cast<int>(std::ceil(t1 * steps)) + 1);
+
+    // 3) Exact search. A pixel is "before" the rectangle if it has not yet
+    //    reached it on some axis, and "after" once it has left on some axis.
+    const int sx = (end.first > start.first) - (end.first < start.first);
+    const int sy = (end.second > start.second) - (end.second < start.second);
+    auto before = [&](int i) {
+        std::pair<int, int> p = pixelAt(i);
+        return (sx > 0 && p.first < r.xmin) || (sx < 0 && p.first > r.xmax) ||
+               (sy > 0 && p.second < r.ymin) || (sy < 0 && p.second > r.ymax);
+    };
+    auto after = [&](int i) {
+        std::pair<int, int> p = pixelAt(i);
+        return (sx > 0 && p.first > r.xmax) || (sx < 0 && p.first < r.xmin) ||
+               (sy > 0 && p.second > r.ymax) || (sy < 0 && p.second < r.ymin);
+    };
+
+    // First step that is not "before".
+    if (before(hi)) {
+        return false;
+    }
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (before(mid)) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    first = lo;
+
+    // Last step that is not "after".
+    hi = std::min(steps, static_cast<int>(std::ceil(t1 * steps)) + 1);
+    if (after(first)) {
+        return false; // The line only passes by a corner of the rectangle
+    }
+    lo = first;
+    while (lo < hi) {
+        int mid = lo + (hi - lo + 1) / 2;
+        if (after(mid)) {
+            hi = mid - 1;
+        } else {
+            lo = mid;
+        }
+    }
+    last = lo;
+    return true;
+}
+
+#endif // CLIP_H
@@ -0,0 +1,212 @@
+// --- Depth Buffer and Hidden Lines ---
+// drawEdges draws every edge whole, so the cube's back edges and the parts
+// of the spine behind it all show. With a depth buffer each pixel remembers
+// how near the nearest thing drawn there is, and a line pixel that lies
+// behind it is left out.
+//
+// Lines alone rarely hide each other, so for hidden-line removal the
+// cube's faces go first, into the depth buffer only (no color): a depth
+// prepass. Their edges are then drawn depth-tested, and only the parts not
+// covered by a nearer face come through.
+//
+// Clearing the whole buffer every frame would cost as much as clearing the
+// framebuffer again. Instead every cell carries the frame ("epoch") it was
+// written in, and a cell from an older frame counts as empty, so clearing is
+// just epoch++. Only when the 8-bit epoch wraps around are the cells really
+// cleared, once every 255 frames.
+#ifndef DEPTH_BUFFER_H
+#define DEPTH_BUFFER_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+#include "Clip.h"
+#include "Transform.h" // DEPTH_BITS, DEPTH_MAX
+
+struct DepthBuffer {
+    // Each cell is (epoch << DEPTH_BITS) | (DEPTH_MAX - depth). Nearer is
+    // bigger, and anything from an older epoch is smaller than anything from
+    // this one, so the whole depth test is one unsigned comparison.
+    std::vector<uint32_t> cells;
+    int width = 0;
+    int height = 0;
+    uint32_t epoch = 0;
+    static const uint32_t MAX_EPOCH = (1u << (32 - DEPTH_BITS)) - 1;
+
+    void resize(int w, int h) {
+        width = w;
+        height = h;
+        cells.assign((size_t)w * h, 0);
+        epoch = 0;
+    }
+
+    // Starts a new frame: forgets every depth written so far.
+    void clear() {
+        if (epoch == MAX_EPOCH) {
+            std::fill(cells.begin(), cells.end(), 0);
+            epoch = 0;
+        }
+        epoch++;
+    }
+
+    uint32_t key(int depth) const {
+        return (epoch << DEPTH_BITS) | static_cast<uint32_t>(DEPTH_MAX - depth);
+    }
+
+    // Depth test and write: true (and remembers the depth) if nothing
+    // nearer was drawn at (x, y) this frame. Equal depths pass, so a line
+    // drawn over itself stays.
+    bool testAndSet(int x, int y, int depth) {
+        uint32_t& cell = cells[(size_t)y * width + x];
+        uint32_t k = key(depth);
+        if (k < cell) {
+            return false;
+        }
+        cell = k;
+        return true;
+    }
+
+    // Keeps the nearer of the stored depth and this one, for the prepass.
+    void write(int x, int y, int depth) {
+        uint32_t& cell = cells[(size_t)y * width + x];
+        cell = std::max(cell, key(depth));
+    }
+};
+
+// --- Depth-Tested Lines ---
+// Bresenham's line (the same pixels as drawLineBresenham in Lines.h) with
+// the depth carried along: it changes by the same amount every step, so it
+// is stepped in 32.32 fixed point like the fixed-point DDA. The depth buffer
+// must cover the target's clip rectangle.
+template <typename Target>
+void drawLineDepth(Target& target, DepthBuffer& depth, int x1, int y1, int z1, int x2, int y2, int z2) {
+    const bool is_steep = std::abs(y2 - y1) > std::abs(x2 - x1);
+    if (is_steep) {
+        std::swap(x1, y1);
+        std::swap(x2, y2);
+    }
+    if (x1 > x2) {
+        std::swap(x1, x2);
+        std::swap(y1, y2);
+        std::swap(z1, z2);
+    }
+
+    const int dx = x2 - x1;
+    const int dy = std::abs(y2 - y1);
+    const int y_step = (y1 < y2) ? 1 : -1;
+    const int half = dx / 2;
+    auto yMovesAt = [&](int i) -> int64_t {
+        return (dx == 0) ? 0 : (int64_t(i) * dy + dx - 1 - half) / dx;
+    };
+    auto pixelAt = [&](int i) {
+        int x = x1 + i;
+        int y = y1 + y_step * static_cast<int>(yMovesAt(i));
+        return is_steep ? std::make_pair(y, x) : std::make_pair(x, y);
+    };
+    int first, last;
+    if (!clipLineSteps(target.clipRect(), dx, pixelAt, first, last)) return;
+
+    const int64_t moves = yMovesAt(first);
+    int error = static_cast<int>(half - int64_t(first) * dy + moves * dx);
+    int y = y1 + y_step * static_cast<int>(moves);
+    // Depth per step, in 32.32 fixed point; the +0.5 makes cutting off the
+    // fraction round to nearest. Multiplied rather than shifted: depths can
+    // be negative, and shifting those left is undefined.
+    const int64_t ONE = int64_t(1) << 32;
+    const int64_t z_step = (dx == 0) ? 0 : int64_t(z2 - z1) * ONE / dx;
+    int64_t z = int64_t(z1) * ONE + ONE / 2 + first * z_step;
+
+    for (int x = x1 + first; x <= x1 + last; x++, z += z_step) {
+        int pz = static_cast<int>(z >> 32);
+        if (is_steep) {
+            if (depth.testAndSet(y, x, pz)) {
+                target.plot(y, x);
+            }
+        } else if (depth.testAndSet(x, y, pz)) {
+            target.plot(x, y);
+        }
+        error -= dy;
+        if (error < 0) {
+            y += y_step;
+            error += dx;
+        }
+    }
+}
+
+// --- Depth Prepass ---
+// A target for the triangle rasterizer (Triangles.h) that writes the
+// triangle's depth instead of a color. Depth is linear on screen, so over
+// a triangle it is a plane: z = z0 + dzdx * (x - x0) + dzdy * (y - y0).
+//
+// Faces are pushed back a little, like glPolygonOffset: by a constant plus
+// how much their depth changes over one pixel. An edge and the face it
+// borders have the same depth in theory, but the edge's pixels sit up to
+// half a pixel off the face's, so without the offset faces seen at a
+// grazing angle would hide parts of their own edges.
+const int HIDDEN_LINE_OFFSET = 64; // About half a model unit at the demo's distance
+
+struct DepthPlaneTarget {
+    DepthBuffer& depth;
+    ClipRect rect;
+    double x0, y0, z0, dzdx, dzdy;
+
+    // The plane through three screen vertices (x, y, depth), pushed back by
+    // the offset above. The triangle must not be degenerate.
+    DepthPlaneTarget(DepthBuffer& buffer, const ClipRect& clip, int ax, int ay, int az, int bx, int by, int bz, int cx,
+                     int cy, int cz)
+        : depth(buffer), rect(clip), x0(ax), y0(ay) {
+        double ux = bx - ax, uy = by - ay, uz = bz - az;
+        double vx = cx - ax, vy = cy - ay, vz = cz - az;
+        double area2 = ux * vy - uy * vx;
+        dzdx = (uz * vy - vz * uy) / area2;
+        dzdy = (vz * ux - uz * vx) / area2;
+        z0 = az + HIDDEN_LINE_OFFSET + std::max(std::abs(dzdx), std::abs(dzdy));
+    }
+
+    ClipRect clipRect() const {
+        return rect;
+    }
+
+    void plot(int x, int y) {
+        hspan(x, x, y);
+    }
+
+    double at(int x, int y) const {
+        return z0 + dzdx * (x - x0) + dzdy * (y - y0);
+    }
+
+    void hspan(int x1, int x2, int y) {
+        if (x1 > x2) {
+            std::swap(x1, x2);
+        }
+        double z1 = at(x1, y), z2 = at(x2, y);
+        if (std::min(z1, z2) < 0.0 || std::max(z1, z2) > DEPTH_MAX) {
+            // Pushed past the far plane (or rounding past the near one): clamp each pixel
+            for (int x = x1; x <= x2; x++) {
+                depth.write(x, y, static_cast<int>(std::min(std::max(at(x, y), 0.0), (double)DEPTH_MAX)));
+            }
+            return;
+        }
+        // Depth is linear along the span, so step it in 32.32 fixed point
+        const double ONE = 4294967296.0;
+        int64_t z = static_cast<int64_t>(z1 * ONE), z_step = static_cast<int64_t>(dzdx * ONE);
+        uint32_t* cell = &depth.cells[(size_t)y * depth.width + x1];
+        for (int x = x1; x <= x2; x++, z += z_step, cell++) {
+            *cell = std::max(*cell, depth.key(static_cast<int>(z >> 32)));
+        }
+    }
+
+    void vspan(int x, int y1, int y2) {
+        if (y1 > y2) {
+            std::swap(y1, y2);
+        }
+        for (int y = y1; y <= y2; y++) {
+            hspan(x, x, y);
+        }
+    }
+};
+
+#endif // DEPTH_BUFFER_H
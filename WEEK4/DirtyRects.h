@@ -0,0 +1,132 @@
+// --- Dirty Rectangles ---
+// Most of a frame does not change: the user's lines and circles stay put
+// and only the cube and the spine move. Instead of clearing and redrawing
+// the whole window, every frame collects the rectangles that changed (the
+// moving objects' old and new bounds, newly added shapes, exposed areas)
+// and only those are repainted. Each rectangle is repainted with itself as
+// the clip rectangle, and the clipping stage (Clip.h) makes that produce
+// exactly the pixels a full repaint would have.
+#ifndef DIRTY_RECTS_H
+#define DIRTY_RECTS_H
+
+#include <algorithm>
+#include <climits>
+#include <vector>
+#include "Circles.h"
+#include "Clip.h"
+#include "Lines.h"
+#include "Transform.h" // ScreenVertices
+
+inline bool isEmpty(const ClipRect& r) {
+    return r.xmin > r.xmax || r.ymin > r.ymax;
+}
+
+inline bool rectsOverlap(const ClipRect& a, const ClipRect& b) {
+    return a.xmin <= b.xmax && b.xmin <= a.xmax && a.ymin <= b.ymax && b.ymin <= a.ymax;
+}
+
+inline ClipRect rectUnion(const ClipRect& a, const ClipRect& b) {
+    return {std::min(a.xmin, b.xmin), std::min(a.ymin, b.ymin), std::max(a.xmax, b.xmax), std::max(a.ymax, b.ymax)};
+}
+
+inline ClipRect rectIntersection(const ClipRect& a, const ClipRect& b) {
+    return {std::max(a.xmin, b.xmin), std::max(a.ymin, b.ymin), std::min(a.xmax, b.xmax), std::min(a.ymax, b.ymax)};
+}
+
+inline long long rectArea(const ClipRect& r) {
+    return isEmpty(r) ? 0 : (long long)(r.xmax - r.xmin + 1) * (r.ymax - r.ymin + 1);
+}
+
+// --- Bounds of What We Draw ---
+// Every line algorithm stays inside its end points' bounding box, and the
+// midpoint circle inside center +/- radius.
+inline ClipRect lineBounds(const Line& l) {
+    return {std::min(l.x1, l.x2), std::min(l.y1, l.y2), std::max(l.x1, l.x2), std::max(l.y1, l.y2)};
+}
+
+inline ClipRect circleBounds(const Circle& c) {
+    return {c.cx - c.radius, c.cy - c.radius, c.cx + c.radius, c.cy + c.radius};
+}
+
+// Ellipses have ellipseBounds (Ellipses.h), polygons keep their bounds
+// from buildEdgeTable (Polygons.h).
+
+// A wireframe's edges all run between its vertices, so the vertices'
+// bounding box covers it.
+inline ClipRect vertexBounds(const ScreenVertices& v) {
+    ClipRect r = {INT_MAX, INT_MAX, INT_MIN, INT_MIN};
+    for (size_t i = 0; i < v.x.size(); i++) {
+        r.xmin = std::min(r.xmin, v.x[i]);
+        r.ymin = std::min(r.ymin, v.y[i]);
+        r.xmax = std::max(r.xmax, v.x[i]);
+        r.ymax = std::max(r.ymax, v.y[i]);
+    }
+    return r;
+}
+
+// --- Damage List ---
+// The set of screen rectangles to repaint this frame. Rectangles that
+// overlap or touch are merged, so the list never repaints a pixel twice,
+// and once it grows past MAX_RECTS everything collapses into one bounding
+// rectangle (at that point a few big repaints beat many small ones).
+struct DamageList {
+    static const int MAX_RECTS = 16;
+
+    ClipRect screen = {0, 0, -1, -1};
+    std::vector<ClipRect> rects;
+
+    void init(int width, int height) {
+        screen = {0, 0, width - 1, height - 1};
+        rects.reserve(MAX_RECTS + 1);
+    }
+
+    void clear() {
+        rects.clear();
+    }
+
+    bool empty() const {
+        return rects.empty();
+    }
+
+    void addAll() {
+        rects.assign(1, screen);
+    }
+
+    void add(ClipRect r) {
+        r = rectIntersection(r, screen);
+        if (isEmpty(r)) {
+            return;
+        }
+        // Merge with everything it overlaps or touches; the grown rectangle
+        // may now reach others, so start over after each merge.
+        for (size_t i = 0; i < rects.size();) {
+            const ClipRect& o = rects[i];
+            if (rectsOverlap({r.xmin - 1, r.ymin - 1, r.xmax + 1, r.ymax + 1}, o)) {
+                r = rectUnion(r, o);
+                rects[i] = rects.back();
+                rects.pop_back();
+                i = 0;
+            } else {
+                i++;
+            }
+        }
+        rects.push_back(r);
+        if ((int)rects.size() > MAX_RECTS) {
+            ClipRect all = rects[0];
+            for (const ClipRect& o : rects) {
+                all = rectUnion(all, o);
+            }
+            rects.assign(1, all);
+        }
+    }
+
+    long long area() const {
+        long long total = 0;
+        for (const ClipRect& r : rects) {
+            total += rectArea(r);
+        }
+        return total;
+    }
+};
+
+#endif // DIRTY_RECTS_H
@@ -0,0 +1,206 @@
+// --- Edge Builder ---
+// Wireframes are drawn edge by edge, but meshes are made of faces, and
+// neighbouring faces share their edges: in a closed mesh each edge belongs
+// to two faces. Drawing every face's outline would draw those lines twice,
+// so the edges are collected once each first.
+//
+// An edge joins two vertices in no particular direction, so it is stored
+// as (lower index, higher index), packed into one 64-bit key, in a hash set
+// with open addressing: a single flat array of keys where an edge that
+// finds its slot taken tries the next one (linear probing). The array is
+// kept at most half full, so a lookup is about one memory access, where
+// sorting all the edges to drop the repeats costs log(n) passes over them.
+// The unique edges come out in the order they were first seen, which
+// follows the faces; they can also be sorted by vertex, so that drawing
+// them walks the vertex arrays in order.
+//
+// The index type is a template parameter: with uint16_t (meshes of up to
+// 65536 vertices) the edge list takes half the memory of int indices. A
+// corner that does not fit in the index type is refused, not wrapped
+// around into some other vertex.
+#ifndef EDGE_BUILDER_H
+#define EDGE_BUILDER_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+#include "Transform.h" // Point3D
+
+template <typename Index = int>
+struct EdgeSet {
+    static constexpr uint64_t EMPTY = ~0ULL; // No edge packs to this: its two indices would be equal
+    std::vector<uint64_t> slots;
+    int shift = 64; // A key's slot is the top bits of its hash
+    std::vector<std::pair<Index, Index>> edges; // Each edge once, lower index first, as first seen
+
+    // Room for "count" edges without growing.
+    void reserve(size_t count) {
+        size_t capacity = 16;
+        while (capacity < 2 * count) {
+            capacity *= 2;
+        }
+        if (capacity > slots.size()) {
+            rehash(capacity);
+        }
+        edges.reserve(count);
+    }
+
+    // Adds the edge between vertices a and b, unless it is already in (or a
+    // and b are the same vertex). True if it was new.
+    bool add(Index a, Index b) {
+        if (a == b) {
+            return false;
+        }
+        if (b < a) {
+            std::swap(a, b);
+        }
+        if (2 * (edges.size() + 1) > slots.size()) {
+            rehash(std::max<size_t>(16, 2 * slots.size()));
+        }
+        if (!insert(pack(a, b))) {
+            return false;
+        }
+        edges.push_back({a, b});
+        return true;
+    }
+
+    // True if vertex index c can be stored as an Index.
+    template <typename Corner>
+    static bool fits(Corner c) {
+        return c >= 0 && static_cast<uint64_t>(c) <= static_cast<uint64_t>(std::numeric_limits<Index>::max());
+    }
+
+    // Adds the outline of a face with n corners, closing it back to the
+    // first. False, adding nothing, if a corner does not fit in Index.
+    template <typename Corner>
+    bool addFace(const Corner* corners, size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            if (!fits(corners[i])) {
+                return false;
+            }
+        }
+        for (size_t i = 0; i < n; i++) {
+            add(static_cast<Index>(corners[i]), static_cast<Index>(corners[i + 1 < n ? i + 1 : 0]));
+        }
+        return true;
+    }
+
+    // Hands over the edges (sorted by lower, then higher index if asked)
+    // and empties the set.
+    std::vector<std::pair<Index, Index>> take(bool sorted = false) {
+        std::vector<std::pair<Index, Index>> out;
+        if (sorted) {
+            sortByVertex(out);
+        } else {
+            out.swap(edges);
+        }
+        edges.clear();
+        slots.clear();
+        shift = 64;
+        return out;
+    }
+
+    // A counting sort on the lower index, in one pass over the edges: each
+    // vertex starts only a few of them, so those few are then sorted by
+    // their higher index in place. Much faster than sorting the whole list.
+    void sortByVertex(std::vector<std::pair<Index, Index>>& out) const {
+        size_t vertices = 0;
+        for (const auto& e : edges) {
+            vertices = std::max(vertices, static_cast<size_t>(e.first) + 1);
+        }
+        std::vector<size_t> start(vertices + 1, 0); // Where each vertex's edges begin in "out"
+        for (const auto& e : edges) {
+            start[e.first + 1]++;
+        }
+        for (size_t v = 0; v < vertices; v++) {
+            start[v + 1] += start[v];
+        }
+        out.resize(edges.size());
+        std::vector<size_t> next(start.begin(), start.end() - 1);
+        for (const auto& e : edges) {
+            out[next[e.first]++] = e;
+        }
+        for (size_t v = 0; v < vertices; v++) {
+            std::sort(out.begin() + start[v], out.begin() + start[v + 1]);
+        }
+    }
+
+    static uint64_t pack(Index a, Index b) {
+        return (uint64_t(static_cast<uint32_t>(a)) << 32) | static_cast<uint32_t>(b);
+    }
+
+    // True if the key was not there yet (and now is).
+    bool insert(uint64_t key) {
+        const size_t mask = slots.size() - 1;
+        // Fibonacci hashing: neighbouring edges land far apart
+        for (size_t i = (key * 0x9E3779B97F4A7C15ULL) >> shift;; i = (i + 1) & mask) {
+            if (slots[i] == key) {
+                return false;
+            }
+            if (slots[i] == EMPTY) {
+                slots[i] = key;
+                return true;
+            }
+        }
+    }
+
+    void rehash(size_t capacity) {
+        slots.assign(capacity, EMPTY);
+        shift = 64;
+        for (size_t c = capacity; c > 1; c /= 2) {
+            shift--;
+        }
+        for (const auto& e : edges) {
+            insert(pack(e.first, e.second));
+        }
+    }
+};
+
+struct EdgeBuilder {
+    // A polyline through the vertices in order.
+    static std::vector<std::pair<int, int>> build(const std::vector<Point3D>& vertices) {
+        std::vector<std::pair<int, int>> edges;
+        for (size_t i = 0; i < vertices.size() - 1; ++i) {
+            edges.push_back({static_cast<int>(i), static_cast<int>(i + 1)});
+        }
+        return edges;
+    }
+
+    // Every edge of a list of faces (any number of corners each), once.
+    // None at all if a corner does not fit in Index.
+    template <typename Index = int>
+    static std::vector<std::pair<Index, Index>> fromFaces(const std::vector<std::vector<int>>& faces,
+                                                          bool sorted = false) {
+        EdgeSet<Index> set;
+        size_t corners = 0;
+        for (const auto& face : faces) {
+            corners += face.size();
+        }
+        set.reserve(corners / 2);
+        for (const auto& face : faces) {
+            if (!set.addFace(face.data(), face.size())) {
+                return {};
+            }
+        }
+        return set.take(sorted);
+    }
+
+    // The same for triangles or quads, or any fixed number of corners.
+    template <typename Index = int, size_t N>
+    static std::vector<std::pair<Index, Index>> fromFaces(const std::vector<std::array<int, N>>& faces,
+                                                          bool sorted = false) {
+        EdgeSet<Index> set;
+        set.reserve(faces.size() * N / 2); // A closed mesh shares every edge
+        for (const auto& face : faces) {
+            if (!set.addFace(face.data(), N)) {
+                return {};
+            }
+        }
+        return set.take(sorted);
+    }
+};
+
+#endif // EDGE_BUILDER_H
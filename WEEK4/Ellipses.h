@@ -0,0 +1,412 @@
+// --- Ellipse Rasterizers ---
+// Axis-aligned ellipses use the midpoint ellipse algorithm, the two-region
+// cousin of the midpoint circle in Circles.h. An ellipse only has 4-way
+// symmetry, so one quadrant is walked and mirrored.
+//
+// Rotated ellipses have no such walk; they are drawn row by row from the
+// ellipse's implicit equation (a conic section) with integer coefficients,
+// stepping each row's ends along with forward differences.
+#ifndef ELLIPSES_H
+#define ELLIPSES_H
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "Circles.h"
+#include "Clip.h"
+#include "Lines.h"
+
+struct Ellipse {
+    int cx, cy;
+    int rx, ry;        // Half-axes, before rotation
+    int angle = 0;     // Degrees, clockwise on screen (y points down)
+    bool filled = false;
+};
+
+// The integer math below stays inside 64 bits up to this half-axis.
+const int ELLIPSE_RADIUS_MAX = 4096;
+
+// --- WEEK 4: 4-Way Symmetry Pixel Plotter ---
+// Like drawCirclePixels, but an ellipse only mirrors across its two axes.
+template <typename Target>
+void drawEllipsePixels(Target& target, int cx, int cy, int x, int y) {
+    target.plot(cx + x, cy + y);
+    target.plot(cx - x, cy + y);
+    target.plot(cx + x, cy - y);
+    target.plot(cx - x, cy - y);
+}
+
+// --- WEEK 4: Midpoint Ellipse Algorithm ---
+// Walks the quadrant from the top (0, ry) to the right end (rx, 0).
+//   Region 1: the curve is flatter than 45 degrees, so x steps every time
+//             and the midpoint test decides whether y steps too.
+//   Region 2: the curve is steeper, so y steps every time and the test
+//             decides about x.
+// The decision parameter is the ellipse equation at the midpoint between
+// the two candidate pixels, multiplied by 4 so it stays an integer.
+// visit(x, y) is called for every point of the quadrant.
+template <typename Visit>
+void walkEllipseQuadrant(int rx, int ry, Visit visit) {
+    const long long rx2 = (long long)rx * rx;
+    const long long ry2 = (long long)ry * ry;
+    int x = 0;
+    int y = ry;
+    visit(x, y);
+
+    // Region 1: midpoint (x + 1, y - 1/2)
+    long long P = 4 * ry2 - 4 * rx2 * ry + rx2;
+    while (ry2 * x < rx2 * y) {
+        x++; // Always step one pixel to the right
+        if (P < 0) {
+            P += 4 * ry2 * (2 * x + 1);
+        } else {
+            y--; // Also step down
+            P += 4 * ry2 * (2 * x + 1) - 8 * rx2 * y;
+        }
+        visit(x, y);
+    }
+
+    // Region 2: midpoint (x + 1/2, y - 1)
+    P = ry2 * (2 * x + 1) * (2 * x + 1) + 4 * rx2 * (long long)(y - 1) * (y - 1) - 4 * rx2 * ry2;
+    while (y > 0) {
+        y--; // Always step one pixel down
+        if (P > 0) {
+            P += 4 * rx2 * (1 - 2 * y);
+        } else {
+            x++; // Also step to the right
+            P += 8 * ry2 * x + 4 * rx2 * (1 - 2 * y);
+        }
+        visit(x, y);
+    }
+
+    // Very flat ellipses reach y = 0 before x reaches rx; the rest of the
+    // middle row is still part of the outline.
+    while (x < rx) {
+        x++;
+        visit(x, 0);
+    }
+}
+
+template <typename Target>
+void traceEllipseMidpoint(Target& target, int centerX, int centerY, int rx, int ry) {
+    walkEllipseQuadrant(rx, ry, [&](int x, int y) { drawEllipsePixels(target, centerX, centerY, x, y); });
+}
+
+// --- Filled Ellipses from the Midpoint Algorithm ---
+// Same idea as traceDiscRows: rowSpan(k, half_width) is called exactly once
+// for every row offset k = 0..ry, and each row ends on the outline pixel
+// the walk drew there. A row is finished (at its widest) when y is about to
+// move down, so it is reported with the x before that step.
+template <typename RowSpan>
+void traceEllipseRows(int rx, int ry, RowSpan rowSpan) {
+    int row = ry, half_width = 0;
+    walkEllipseQuadrant(rx, ry, [&](int x, int y) {
+        if (y != row) {
+            rowSpan(row, half_width);
+            row = y;
+        }
+        half_width = x;
+    });
+    rowSpan(row, half_width);
+}
+
+template <typename Target>
+void fillEllipseMidpoint(Target& target, int centerX, int centerY, int rx, int ry) {
+    traceEllipseRows(rx, ry, [&](int k, int half_width) {
+        target.hspan(centerX - half_width, centerX + half_width, centerY + k);
+        if (k != 0) {
+            target.hspan(centerX - half_width, centerX + half_width, centerY - k);
+        }
+    });
+}
+
+// --- Rotated Ellipses: Integer Conic Stepper ---
+// A rotated ellipse centered on the origin is the set of points with
+//     Q(x, y) = A*x*x + B*x*y + C*y*y - F <= 0
+// The coefficients are worked out once in floating point, scaled up by
+// CONIC_SCALE and rounded; everything per pixel is integer. A pixel belongs
+// to the ellipse when Q at its center is <= 0.
+const int CONIC_SCALE = 256;
+
+struct EllipseConic {
+    long long A, B, C, F;
+
+    long long at(long long x, long long y) const {
+        return A * x * x + B * x * y + C * y * y - F;
+    }
+};
+
+inline EllipseConic rotatedEllipseConic(int rx, int ry, int angle_degrees) {
+    const double theta = angle_degrees * M_PI / 180.0;
+    const double c = std::cos(theta), s = std::sin(theta);
+    const double a2 = (double)rx * rx, b2 = (double)ry * ry;
+    EllipseConic q;
+    q.A = std::llround(CONIC_SCALE * (b2 * c * c + a2 * s * s));
+    q.B = std::llround(CONIC_SCALE * 2.0 * (b2 - a2) * s * c);
+    q.C = std::llround(CONIC_SCALE * (b2 * s * s + a2 * c * c));
+    q.F = (long long)CONIC_SCALE * rx * rx * ry * ry;
+    return q;
+}
+
+// Reports the ellipse's rows y = first_row, first_row + 1, ... up to
+// last_row (or the ellipse's top) as rowSpan(y, left, right). A row with no
+// pixel center inside comes out with left > right; very thin ellipses can
+// have those between full rows. The ellipse is symmetric through its
+// center, so row -y is the mirror image: from -right to -left.
+//
+// Each row's ends start from the previous row's and move a pixel at a time
+// while Q says they are on the wrong side. Moving x by one changes Q by
+// A*(2x + 1) + B*y, so each step is a few additions, and only the row's
+// lowest point is evaluated in full. Over the whole ellipse the ends move
+// about as far as its outline is long. The first row's ends are guessed
+// from the quadratic formula; the guess only has to be close, the integer
+// steps settle the exact pixel.
+template <typename RowSpan>
+void traceConicRows(const EllipseConic& q, int first_row, int last_row, RowSpan rowSpan) {
+    // Each row's lowest Q is at x = -B*y / (2A). Its floor is kept as a
+    // quotient and remainder and stepped along, instead of dividing per row.
+    const long long den = 2 * q.A;
+    auto floorDiv = [](long long num, long long d) { return num >= 0 ? num / d : -((-num + d - 1) / d); };
+    long long center = floorDiv(-q.B * first_row, den);
+    long long remainder = -q.B * first_row - center * den;
+    const long long center_step = floorDiv(-q.B, den);
+    const long long remainder_step = -q.B - center_step * den;
+
+    // Beyond y = sqrt(4AF / (4AC - B*B)) the real ellipse has ended
+    const double extent = std::sqrt(4.0 * q.A * q.F / std::fmax(4.0 * q.A * q.C - (double)q.B * q.B, 1.0));
+    last_row = static_cast<int>(std::min<double>(last_row, std::ceil(extent) + 1));
+
+    // The ends' Q values carry over to the next row: Q(x, y + 1) = Q(x, y) + B*x + C*(2y + 1)
+    bool carried = false;
+    long long left = 0, right = 0, left_value = 0, right_value = 0;
+    for (int y = first_row; y <= last_row; y++) {
+        if (y != first_row) {
+            center += center_step;
+            remainder += remainder_step;
+            if (remainder >= den) {
+                remainder -= den;
+                center++;
+            }
+        }
+        if (carried) {
+            left_value += q.B * left + q.C * (2 * y - 1);
+            right_value += q.B * right + q.C * (2 * y - 1);
+        }
+        // The better of the two pixels around the lowest point; if that is
+        // outside, so is the whole row.
+        long long center_value = q.at(center, y);
+        long long next_value = center_value + q.A * (2 * center + 1) + q.B * y;
+        long long inside = center, inside_value = center_value;
+        if (next_value < center_value) {
+            inside = center + 1;
+            inside_value = next_value;
+        }
+        if (inside_value > 0) {
+            rowSpan(y, 0, -1);
+            carried = false;
+            continue;
+        }
+        if (!carried) {
+            // First row with pixels (or the first after a gap): guess the
+            // ends with the quadratic formula
+            double b = (double)q.B * y, c = (double)q.C * y * y - (double)q.F;
+            double root = std::sqrt(std::fmax(0.0, b * b - 4.0 * q.A * c));
+            left = std::llround((-b - root) / den);
+            right = std::llround((-b + root) / den);
+            left_value = q.at(left, y);
+            right_value = q.at(right, y);
+            carried = true;
+        }
+
+        // Right end: from outside, step left to the first inside pixel;
+        // from inside, step right while the next pixel is still inside.
+        long long x = right, value = right_value;
+        if (x < inside) {
+            x = inside;
+            value = inside_value;
+        }
+        if (value > 0) {
+            while (value > 0) {
+                value -= q.A * (2 * x - 1) + q.B * y; // Q(x - 1) = Q(x) - (A*(2x - 1) + B*y)
+                x--;
+            }
+        } else {
+            long long step = q.A * (2 * x + 1) + q.B * y; // Q(x + 1) - Q(x)
+            while (value + step <= 0) {
+                value += step;
+                step += 2 * q.A;
+                x++;
+            }
+        }
+        right = x;
+        right_value = value;
+
+        // Left end, mirrored.
+        x = left;
+        value = left_value;
+        if (x > inside) {
+            x = inside;
+            value = inside_value;
+        }
+        if (value > 0) {
+            while (value > 0) {
+                value += q.A * (2 * x + 1) + q.B * y; // Q(x + 1) = Q(x) + A*(2x + 1) + B*y
+                x++;
+            }
+        } else {
+            long long step = -q.A * (2 * x - 1) - q.B * y; // Q(x - 1) - Q(x)
+            while (value + step <= 0) {
+                value += step;
+                step += 2 * q.A;
+                x--;
+            }
+        }
+        left = x;
+        left_value = value;
+
+        rowSpan(y, static_cast<int>(left), static_cast<int>(right));
+    }
+}
+
+struct EllipseRow {
+    int left, right;
+};
+
+// The rows of a rotated ellipse that one draw call needs. Only rows with
+// |k| from "first" on are traced (a tile only needs its own band), kept in
+// a buffer that is reused between calls (tiles draw on several threads).
+struct RotatedEllipseRows {
+    int first = 0;
+    std::vector<EllipseRow> half; // Rows k = first, first + 1, ... as far as needed
+
+    // Does row k have any pixels?
+    bool has(int k) const {
+        int i = std::abs(k) - first;
+        return i >= 0 && i < static_cast<int>(half.size()) && half[i].left <= half[i].right;
+    }
+
+    EllipseRow at(int k) const {
+        const EllipseRow& row = half[std::abs(k) - first];
+        return k >= 0 ? row : EllipseRow{-row.right, -row.left};
+    }
+};
+
+// Traces the rows k = kmin..kmax (relative to the center), plus one more
+// on each side for the outline's neighbour test.
+inline const RotatedEllipseRows& rotatedEllipseRows(const EllipseConic& q, int kmin, int kmax) {
+    thread_local RotatedEllipseRows rows;
+    kmin--;
+    kmax++;
+    int lo = (kmin <= 0 && kmax >= 0) ? 0 : std::min(std::abs(kmin), std::abs(kmax));
+    int hi = std::max(std::abs(kmin), std::abs(kmax));
+    rows.first = lo;
+    rows.half.clear();
+    traceConicRows(q, lo, hi, [&](int, int left, int right) { rows.half.push_back({left, right}); });
+    return rows;
+}
+
+template <typename Target>
+void fillRotatedEllipse(Target& target, int centerX, int centerY, const RotatedEllipseRows& rows, int kmin, int kmax) {
+    for (int k = kmin; k <= kmax; k++) {
+        if (rows.has(k)) {
+            EllipseRow row = rows.at(k);
+            target.hspan(centerX + row.left, centerX + row.right, centerY + k);
+        }
+    }
+}
+
+// The outline is every pixel of the filled ellipse that is not surrounded:
+// a row's pixels that the rows above and below both cover (inside its own
+// ends) are interior, so each row draws at most two spans.
+template <typename Target>
+void traceRotatedEllipse(Target& target, int centerX, int centerY, const RotatedEllipseRows& rows, int kmin,
+                         int kmax) {
+    for (int k = kmin; k <= kmax; k++) {
+        if (!rows.has(k)) {
+            continue;
+        }
+        EllipseRow row = rows.at(k);
+        int inner_left = row.left + 1, inner_right = row.right - 1;
+        if (rows.has(k - 1) && rows.has(k + 1)) {
+            EllipseRow above = rows.at(k - 1), below = rows.at(k + 1);
+            inner_left = std::max({inner_left, above.left, below.left});
+            inner_right = std::min({inner_right, above.right, below.right});
+        } else {
+            inner_right = inner_left - 1; // The top and bottom rows are all outline
+        }
+        if (inner_left > inner_right) {
+            target.hspan(centerX + row.left, centerX + row.right, centerY + k);
+        } else {
+            target.hspan(centerX + row.left, centerX + inner_left - 1, centerY + k);
+            target.hspan(centerX + inner_right + 1, centerX + row.right, centerY + k);
+        }
+    }
+}
+
+// --- Bounds and Dispatch ---
+inline bool isAxisAligned(const Ellipse& e) {
+    return e.angle % 90 == 0;
+}
+
+// A rectangle the ellipse's pixels stay inside.
+inline ClipRect ellipseBounds(const Ellipse& e) {
+    int hx = e.rx, hy = e.ry;
+    if (!isAxisAligned(e)) {
+        const double theta = e.angle * M_PI / 180.0;
+        const double c = std::cos(theta), s = std::sin(theta);
+        // Half the width and height of the rotated ellipse, plus a pixel for
+        // the rounded coefficients
+        hx = static_cast<int>(std::ceil(std::sqrt(e.rx * e.rx * c * c + e.ry * e.ry * s * s))) + 1;
+        hy = static_cast<int>(std::ceil(std::sqrt(e.rx * e.rx * s * s + e.ry * e.ry * c * c))) + 1;
+    } else if (e.angle % 180 != 0) {
+        std::swap(hx, hy);
+    }
+    return {e.cx - hx, e.cy - hy, e.cx + hx, e.cy + hy};
+}
+
+// Draws an ellipse, outlined or filled, in any rotation.
+template <typename Target>
+void drawEllipse(Target& target, const Ellipse& ellipse) {
+    Ellipse e = ellipse;
+    e.rx = std::min(std::abs(e.rx), ELLIPSE_RADIUS_MAX);
+    e.ry = std::min(std::abs(e.ry), ELLIPSE_RADIUS_MAX);
+    const ClipRect bounds = ellipseBounds(e);
+
+    if (isAxisAligned(e)) {
+        int rx = e.rx, ry = e.ry;
+        if (e.angle % 180 != 0) {
+            std::swap(rx, ry);
+        }
+        drawClippedBounds(target, bounds, [&](auto& t) {
+            if (e.filled) {
+                fillEllipseMidpoint(t, e.cx, e.cy, rx, ry);
+            } else {
+                traceEllipseMidpoint(t, e.cx, e.cy, rx, ry);
+            }
+        });
+    } else if (e.rx == 0 || e.ry == 0) {
+        // Flattened to a line through the center
+        const double theta = e.angle * M_PI / 180.0;
+        int dx = static_cast<int>(std::lround(std::max(e.rx, e.ry) * std::cos(theta + (e.rx == 0 ? M_PI / 2 : 0))));
+        int dy = static_cast<int>(std::lround(std::max(e.rx, e.ry) * std::sin(theta + (e.rx == 0 ? M_PI / 2 : 0))));
+        drawLine(target, DrawAlgorithm::BRESENHAM, e.cx - dx, e.cy - dy, e.cx + dx, e.cy + dy);
+    } else {
+        // Only the rows inside the clip rectangle are traced
+        const ClipRect rect = target.clipRect();
+        const int kmin = std::max(rect.ymin, bounds.ymin) - e.cy;
+        const int kmax = std::min(rect.ymax, bounds.ymax) - e.cy;
+        if (kmin > kmax) {
+            return;
+        }
+        const RotatedEllipseRows& rows = rotatedEllipseRows(rotatedEllipseConic(e.rx, e.ry, e.angle), kmin, kmax);
+        drawClippedBounds(target, bounds, [&](auto& t) {
+            if (e.filled) {
+                fillRotatedEllipse(t, e.cx, e.cy, rows, kmin, kmax);
+            } else {
+                traceRotatedEllipse(t, e.cx, e.cy, rows, kmin, kmax);
+            }
+        });
+    }
+}
+
+#endif // ELLIPSES_H
@@ -0,0 +1,126 @@
+// --- Frame Scheduler ---
+// Replaces the old usleep(16667) after every frame. That made the real frame
+// period "work + 16.7 ms", so the frame rate sagged as soon as there was any
+// work. Here every frame has an absolute deadline on CLOCK_MONOTONIC, one
+// period after the previous one, and the loop sleeps until exactly that
+// time no matter how long the frame took.
+//
+// While waiting, the scheduler also watches a file descriptor (the X
+// connection) with poll(), so input is handled the moment it arrives
+// instead of after the sleep.
+#ifndef FRAME_SCHEDULER_H
+#define FRAME_SCHEDULER_H
+
+#include <cerrno>
+#include <cmath>
+#include <poll.h>
+#include <time.h>
+
+inline long long monotonicNanos() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// What the scheduler saw since the last takeStats().
+struct ScheduleStats {
+    int missed = 0;        // Deadlines that passed while a frame was still being made
+    double jitter_ms = 0;  // Standard deviation of the time between frame starts
+    double worst_ms = 0;   // Longest time between two frame starts
+};
+
+struct FrameScheduler {
+    long long period_ns = 0; // 0 = uncapped, frames start back to back
+    long long next_deadline = 0;
+    long long last_frame_start = 0;
+
+    // Running sums for the current stats window
+    int missed = 0;
+    int intervals = 0;
+    double interval_sum = 0, interval_sum_sq = 0, interval_max = 0;
+
+    void init(double target_fps) {
+        period_ns = target_fps > 0 ? std::llround(1e9 / target_fps) : 0;
+        next_deadline = monotonicNanos(); // The first frame is due right away
+    }
+
+    bool uncapped() const {
+        return period_ns == 0;
+    }
+
+    double targetFps() const {
+        return uncapped() ? 0.0 : 1e9 / period_ns;
+    }
+
+    // Blocks until the next frame is due or "fd" has something to read.
+    // Returns true when the frame is due, false when input came first.
+    bool wait(int fd) {
+        if (uncapped()) {
+            return true;
+        }
+        long long remaining = next_deadline - monotonicNanos();
+        if (remaining <= 0) {
+            return true;
+        }
+        // poll() only counts whole milliseconds, so it covers the wait up to
+        // the last millisecond and clock_nanosleep hits the deadline exactly.
+        int timeout_ms = static_cast<int>(remaining / 1000000) - 1;
+        if (timeout_ms > 0) {
+            pollfd input = {fd, POLLIN, 0};
+            if (poll(&input, 1, timeout_ms) > 0) {
+                return false;
+            }
+        }
+        timespec deadline = {static_cast<time_t>(next_deadline / 1000000000LL),
+                             static_cast<long>(next_deadline % 1000000000LL)};
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL) == EINTR) {
+        }
+        return true;
+    }
+
+    // Call as a frame starts: records the time since the last frame started
+    // and moves the deadline one period on.
+    void beginFrame() {
+        long long now = monotonicNanos();
+        if (last_frame_start != 0) {
+            double interval_ms = (now - last_frame_start) / 1e6;
+            intervals++;
+            interval_sum += interval_ms;
+            interval_sum_sq += interval_ms * interval_ms;
+            interval_max = std::fmax(interval_max, interval_ms);
+        }
+        last_frame_start = now;
+        next_deadline += period_ns;
+    }
+
+    // Call once a frame is finished. If it ran past the next deadline those
+    // deadlines count as missed, and the schedule skips ahead to the first
+    // one still in the future (instead of rushing out frames to catch up).
+    void endFrame() {
+        if (uncapped()) {
+            return;
+        }
+        long long now = monotonicNanos();
+        if (now > next_deadline) {
+            long long late_periods = (now - next_deadline) / period_ns + 1;
+            missed += static_cast<int>(late_periods);
+            next_deadline += late_periods * period_ns;
+        }
+    }
+
+    ScheduleStats takeStats() {
+        ScheduleStats stats;
+        stats.missed = missed;
+        if (intervals > 0) {
+            double mean = interval_sum / intervals;
+            stats.jitter_ms = std::sqrt(std::fmax(0.0, interval_sum_sq / intervals - mean * mean));
+            stats.worst_ms = interval_max;
+        }
+        missed = 0;
+        intervals = 0;
+        interval_sum = interval_sum_sq = interval_max = 0;
+        return stats;
+    }
+};
+
+#endif // FRAME_SCHEDULER_H
@@ -0,0 +1,131 @@
+#ifndef FRAMEBUFFER_H
+#define FRAMEBUFFER_H
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include "Clip.h"
+#include "Gamma.h"
+
+// --- Render Targets ---
+// Every rasterizer (Lines.h, Circles.h) is a template over a "Target" that needs a
+// plot(x, y) member, plus hspan(x1, x2, y) / vspan(x, y1, y2) for algorithms
+// that produce whole runs of pixels (both ends inclusive). This lets the exact
+// same algorithm code draw either straight to the X server or into our own
+// framebuffer in memory.
+//
+// Anti-aliased algorithms call plotCoverage(x, y, coverage) instead of
+// plot(x, y), with coverage from 0 to COVERAGE_FULL (Gamma.h). Targets that
+// can blend mix the color in; the others just plot the pixel if it is at
+// least half covered.
+//
+// A target also reports its clipRect(). Rasterizers clip against it before
+// drawing (see Clip.h), so targets never see a pixel outside that rectangle
+// and do not have to check every pixel themselves.
+
+// CPU-side 32-bit framebuffer. The pixel memory is owned by whoever set it up
+// (a std::vector or a MIT-SHM segment), so this struct is cheap to copy around.
+struct Framebuffer {
+    uint32_t* pixels = nullptr;
+    int width = 0;
+    int height = 0;
+    int stride = 0;     // Pixels per row (may be larger than width)
+    uint32_t color = 0; // Current drawing color, in the X visual's pixel format
+    ClipRect clip = {0, 0, -1, -1}; // The whole buffer, or one tile of it
+
+    ClipRect clipRect() const {
+        return clip;
+    }
+
+    // No bounds check here: everything reaching the framebuffer was clipped.
+    void plot(int x, int y) {
+        pixels[y * stride + x] = color;
+    }
+
+    // Blends the current color in, gamma-correctly.
+    void plotCoverage(int x, int y, int coverage) {
+        uint32_t& pixel = pixels[y * stride + x];
+        pixel = (coverage >= COVERAGE_FULL) ? color : blendPixel(GAMMA_TABLES, pixel, color, coverage);
+    }
+
+    // Spans are filled as one contiguous run, which the compiler turns into
+    // vector stores.
+    void hspan(int x1, int x2, int y) {
+        if (x1 > x2) {
+            std::swap(x1, x2);
+        }
+        std::fill_n(pixels + y * stride + x1, x2 - x1 + 1, color);
+    }
+
+    void vspan(int x, int y1, int y2) {
+        if (y1 > y2) {
+            std::swap(y1, y2);
+        }
+        uint32_t* p = pixels + y1 * stride + x;
+        for (int y = y1; y <= y2; y++, p += stride) {
+            *p = color;
+        }
+    }
+
+    void clear(uint32_t clear_color) {
+        for (int y = 0; y < height; y++) {
+            std::fill_n(pixels + y * stride, width, clear_color);
+        }
+    }
+
+    // Clears one rectangle, which must lie inside the buffer.
+    void clearRect(const ClipRect& r, uint32_t clear_color) {
+        for (int y = r.ymin; y <= r.ymax; y++) {
+            std::fill_n(pixels + y * stride + r.xmin, r.xmax - r.xmin + 1, clear_color);
+        }
+    }
+};
+
+// Wraps another target and drops whatever falls outside the clip rectangle.
+// Shapes that cross the edge of the screen draw through this, so shapes
+// that are fully inside pay nothing for clipping.
+template <typename Target>
+struct ClippedTarget {
+    Target& inner;
+    ClipRect rect;
+
+    ClipRect clipRect() const {
+        return rect;
+    }
+
+    void plot(int x, int y) {
+        if (computeOutCode(x, y, rect) == CLIP_INSIDE) {
+            inner.plot(x, y);
+        }
+    }
+
+    void plotCoverage(int x, int y, int coverage) {
+        if (computeOutCode(x, y, rect) == CLIP_INSIDE) {
+            inner.plotCoverage(x, y, coverage);
+        }
+    }
+
+    void hspan(int x1, int x2, int y) {
+        if (x1 > x2) {
+            std::swap(x1, x2);
+        }
+        x1 = std::max(x1, rect.xmin);
+        x2 = std::min(x2, rect.xmax);
+        if (y >= rect.ymin && y <= rect.ymax && x1 <= x2) {
+            inner.hspan(x1, x2, y);
+        }
+    }
+
+    void vspan(int x, int y1, int y2) {
+        if (y1 > y2) {
+            std::swap(y1, y2);
+        }
+        y1 = std::max(y1, rect.ymin);
+        y2 = std::min(y2, rect.ymax);
+        if (x >= rect.xmin && x <= rect.xmax && y1 <= y2) {
+            inner.vspan(x, y1, y2);
+        }
+    }
+};
+
+#endif // FRAMEBUFFER_H
@@ -0,0 +1,61 @@
+// --- Gamma-Correct Coverage Blending ---
+// Anti-aliased lines (drawLineWu in Lines.h) hand each pixel a coverage:
+// how much of it the line covers, from 0 to COVERAGE_FULL. The pixel then
+// becomes a mix of the line color and what was there before.
+//
+// Pixel values are sRGB, which is not linear in light: mixing the bytes
+// directly makes half-covered pixels too dark and lines look ropey. So
+// each channel is converted to linear light, mixed there and converted
+// back. Both conversions are lookup tables built once with pow(); per
+// pixel there are only table lookups, two multiplies and a shift.
+#ifndef GAMMA_H
+#define GAMMA_H
+
+#include <cmath>
+#include <cstdint>
+
+const int COVERAGE_FULL = 256; // Coverage of a pixel the line fully covers
+const int LINEAR_BITS = 12;    // Precision of the linear-light values
+
+struct GammaTables {
+    uint16_t to_linear[256];            // sRGB byte -> linear light
+    uint8_t to_srgb[1 << LINEAR_BITS];  // Linear light -> sRGB byte
+};
+
+inline GammaTables makeGammaTables() {
+    GammaTables tables;
+    const int linear_max = (1 << LINEAR_BITS) - 1;
+    for (int i = 0; i < 256; i++) {
+        double c = i / 255.0;
+        double linear = (c <= 0.04045) ? c / 12.92 : std::pow((c + 0.055) / 1.055, 2.4);
+        tables.to_linear[i] = static_cast<uint16_t>(std::lround(linear * linear_max));
+    }
+    for (int i = 0; i <= linear_max; i++) {
+        double linear = static_cast<double>(i) / linear_max;
+        double c = (linear <= 0.0031308) ? linear * 12.92 : 1.055 * std::pow(linear, 1.0 / 2.4) - 0.055;
+        tables.to_srgb[i] = static_cast<uint8_t>(std::lround(c * 255.0));
+    }
+    return tables;
+}
+
+// Built before main() runs, shared by every target. A global (rather than
+// a function-local static) keeps the per-pixel path free of the "already
+// initialized?" check.
+inline const GammaTables GAMMA_TABLES = makeGammaTables();
+
+// Mixes one 8-bit channel: "coverage" parts of src over dst.
+inline uint8_t blendChannel(const GammaTables& g, uint8_t dst, uint8_t src, int coverage) {
+    int d = g.to_linear[dst];
+    int s = g.to_linear[src];
+    // The weighted sum is never negative, so the shift is a plain division
+    return g.to_srgb[(d * (COVERAGE_FULL - coverage) + s * coverage) >> 8];
+}
+
+// Mixes a 0x00RRGGBB pixel (any channel order with 8 bits each works).
+inline uint32_t blendPixel(const GammaTables& g, uint32_t dst, uint32_t src, int coverage) {
+    return static_cast<uint32_t>(blendChannel(g, dst & 0xFF, src & 0xFF, coverage)) |
+           static_cast<uint32_t>(blendChannel(g, (dst >> 8) & 0xFF, (src >> 8) & 0xFF, coverage)) << 8 |
+           static_cast<uint32_t>(blendChannel(g, (dst >> 16) & 0xFF, (src >> 16) & 0xFF, coverage)) << 16;
+}
+
+#endif // GAMMA_H
@@ -0,0 +1,217 @@
+// --- Instanced Cubes (Stress Mode) ---
+// Thousands of copies ("instances") of the cube, each bouncing around the
+// window and spinning at its own speed: the load test for how many lines
+// the renderer keeps up with before frames are missed.
+//
+// The instances are stored as a structure of arrays: one array per field
+// (all the x positions, then all the y positions, ...) instead of one
+// struct per cube. A step then updates each field with the same operation
+// across consecutive floats, 8 (AVX) or 4 (SSE2) cubes per instruction.
+// The spin is applied by rotating each cube's (cos, sin) pair by its own
+// fixed (cos, sin) step, so a step needs no sin() or cos() at all.
+//
+// All corners go into one vertex array, corner k of cube i at k * count + i,
+// so that placing them is again the same operation across consecutive
+// cubes, and the whole array is projected with one transformVertices call.
+#ifndef INSTANCES_H
+#define INSTANCES_H
+
+#include <array>
+#include <cmath>
+#include <random>
+#include <utility>
+#include <vector>
+#if defined(__SSE2__) || defined(__AVX__)
+#include <immintrin.h> // SIMD instance updates
+#endif
+#include "Transform.h"
+
+const size_t MAX_INSTANCES = 100000;
+
+struct CubeInstances {
+    std::vector<float> x, y, dx, dy;           // Center on screen, and how far it moves per step
+    std::vector<float> cos_angle, sin_angle;   // Current rotation around Y
+    std::vector<float> cos_spin, sin_spin;     // Rotation per step
+    float min_x = 40, max_x = 560, min_y = 40, max_y = 560; // Where the centers bounce, like the cube's
+
+    size_t size() const {
+        return x.size();
+    }
+
+    // Replaces the instances with "count" new ones at random places, moving
+    // and spinning in random directions.
+    void spawn(size_t count, unsigned seed) {
+        std::minstd_rand random(seed);
+        auto uniform = [&](float lo, float hi) { return std::uniform_real_distribution<float>(lo, hi)(random); };
+        for (auto* field : {&x, &y, &dx, &dy, &cos_angle, &sin_angle, &cos_spin, &sin_spin}) {
+            field->resize(count);
+        }
+        for (size_t i = 0; i < count; i++) {
+            x[i] = uniform(min_x, max_x);
+            y[i] = uniform(min_y, max_y);
+            dx[i] = uniform(0.5f, 2.0f) * (random() % 2 ? 1 : -1);
+            dy[i] = uniform(0.5f, 2.0f) * (random() % 2 ? 1 : -1);
+            float angle = uniform(0.0f, 6.2831853f), spin = uniform(-0.03f, 0.03f);
+            cos_angle[i] = std::cos(angle);
+            sin_angle[i] = std::sin(angle);
+            cos_spin[i] = std::cos(spin);
+            sin_spin[i] = std::sin(spin);
+        }
+    }
+
+    // One simulation step for every instance: move, bounce off the edges
+    // (by setting the velocity's sign bit to point back in), and turn. Only
+    // the sign is set, not flipped, so a cube pushed past an edge (by a
+    // collision, Collisions.h) heads back in rather than getting stuck.
+    void step() {
+        const size_t count = size();
+        float* __restrict px = x.data();
+        float* __restrict py = y.data();
+        float* __restrict vx = dx.data();
+        float* __restrict vy = dy.data();
+        float* __restrict c = cos_angle.data();
+        float* __restrict s = sin_angle.data();
+        const float* __restrict spin_c = cos_spin.data();
+        const float* __restrict spin_s = sin_spin.data();
+
+        size_t i = 0;
+#if defined(__AVX__)
+        const __m256 sign = _mm256_set1_ps(-0.0f);
+        for (; i + 8 <= count; i += 8) {
+            auto move = [&](float* p, float* v, float lo, float hi) {
+                __m256 vel = _mm256_loadu_ps(v + i);
+                __m256 pos = _mm256_add_ps(_mm256_loadu_ps(p + i), vel);
+                __m256 below = _mm256_cmp_ps(pos, _mm256_set1_ps(lo), _CMP_LE_OQ);
+                __m256 above = _mm256_cmp_ps(pos, _mm256_set1_ps(hi), _CMP_GE_OQ);
+                // Past an edge: |v| with the sign bit taken from "above"
+                __m256 bounced = _mm256_or_ps(_mm256_andnot_ps(sign, vel), _mm256_and_ps(above, sign));
+                _mm256_storeu_ps(p + i, pos);
+                _mm256_storeu_ps(v + i, _mm256_blendv_ps(vel, bounced, _mm256_or_ps(below, above)));
+            };
+            move(px, vx, min_x, max_x);
+            move(py, vy, min_y, max_y);
+            __m256 ca = _mm256_loadu_ps(c + i), sa = _mm256_loadu_ps(s + i);
+            __m256 cs = _mm256_loadu_ps(spin_c + i), ss = _mm256_loadu_ps(spin_s + i);
+            __m256 nc = _mm256_sub_ps(_mm256_mul_ps(ca, cs), _mm256_mul_ps(sa, ss));
+            __m256 ns = _mm256_add_ps(_mm256_mul_ps(sa, cs), _mm256_mul_ps(ca, ss));
+            // Rounding would slowly grow or shrink the cube: pull the length back to 1
+            __m256 length2 = _mm256_add_ps(_mm256_mul_ps(nc, nc), _mm256_mul_ps(ns, ns));
+            __m256 k = _mm256_sub_ps(_mm256_set1_ps(1.5f), _mm256_mul_ps(_mm256_set1_ps(0.5f), length2));
+            _mm256_storeu_ps(c + i, _mm256_mul_ps(nc, k));
+            _mm256_storeu_ps(s + i, _mm256_mul_ps(ns, k));
+        }
+#endif
+#if defined(__SSE2__)
+        const __m128 sign4 = _mm_set1_ps(-0.0f);
+        for (; i + 4 <= count; i += 4) {
+            auto move = [&](float* p, float* v, float lo, float hi) {
+                __m128 vel = _mm_loadu_ps(v + i);
+                __m128 pos = _mm_add_ps(_mm_loadu_ps(p + i), vel);
+                __m128 below = _mm_cmple_ps(pos, _mm_set1_ps(lo)), above = _mm_cmpge_ps(pos, _mm_set1_ps(hi));
+                __m128 bounced = _mm_or_ps(_mm_andnot_ps(sign4, vel), _mm_and_ps(above, sign4));
+                __m128 out = _mm_or_ps(below, above); // No blend in SSE2: mask both ways
+                _mm_storeu_ps(p + i, pos);
+                _mm_storeu_ps(v + i, _mm_or_ps(_mm_and_ps(out, bounced), _mm_andnot_ps(out, vel)));
+            };
+            move(px, vx, min_x, max_x);
+            move(py, vy, min_y, max_y);
+            __m128 ca = _mm_loadu_ps(c + i), sa = _mm_loadu_ps(s + i);
+            __m128 cs = _mm_loadu_ps(spin_c + i), ss = _mm_loadu_ps(spin_s + i);
+            __m128 nc = _mm_sub_ps(_mm_mul_ps(ca, cs), _mm_mul_ps(sa, ss));
+            __m128 ns = _mm_add_ps(_mm_mul_ps(sa, cs), _mm_mul_ps(ca, ss));
+            __m128 length2 = _mm_add_ps(_mm_mul_ps(nc, nc), _mm_mul_ps(ns, ns));
+            __m128 k = _mm_sub_ps(_mm_set1_ps(1.5f), _mm_mul_ps(_mm_set1_ps(0.5f), length2));
+            _mm_storeu_ps(c + i, _mm_mul_ps(nc, k));
+            _mm_storeu_ps(s + i, _mm_mul_ps(ns, k));
+        }
+#endif
+        // Leftover instances (or everything, without SIMD): same math, one at a time
+        for (; i < count; i++) {
+            px[i] += vx[i];
+            py[i] += vy[i];
+            if (px[i] <= min_x) vx[i] = std::abs(vx[i]);
+            if (px[i] >= max_x) vx[i] = -std::abs(vx[i]);
+            if (py[i] <= min_y) vy[i] = std::abs(vy[i]);
+            if (py[i] >= max_y) vy[i] = -std::abs(vy[i]);
+            float nc = c[i] * spin_c[i] - s[i] * spin_s[i];
+            float ns = s[i] * spin_c[i] + c[i] * spin_s[i];
+            float k = 1.5f - 0.5f * (nc * nc + ns * ns);
+            c[i] = nc * k;
+            s[i] = ns * k;
+        }
+    }
+
+    // Every instance's copy of "model" in the world: turned around Y, then
+    // moved so its center is at (x + offset_x, y + offset_y, offset_z), the
+    // same as objectModelMatrix does for one object.
+    void place(const VertexArray& model, float offset_x, float offset_y, float offset_z, VertexArray& world) const {
+        const size_t count = size(), corners = model.x.size();
+        world.x.resize(count * corners);
+        world.y.resize(count * corners);
+        world.z.resize(count * corners);
+        const float* __restrict px = x.data();
+        const float* __restrict py = y.data();
+        const float* __restrict c = cos_angle.data();
+        const float* __restrict s = sin_angle.data();
+        for (size_t k = 0; k < corners; k++) {
+            const float mx = model.x[k], my = model.y[k], mz = model.z[k];
+            float* __restrict wx = world.x.data() + k * count;
+            float* __restrict wy = world.y.data() + k * count;
+            float* __restrict wz = world.z.data() + k * count;
+            size_t i = 0;
+#if defined(__AVX__)
+            for (; i + 8 <= count; i += 8) {
+                __m256 ci = _mm256_loadu_ps(c + i), si = _mm256_loadu_ps(s + i);
+                __m256 rx = _mm256_sub_ps(_mm256_mul_ps(ci, _mm256_set1_ps(mx)), _mm256_mul_ps(si, _mm256_set1_ps(mz)));
+                __m256 rz = _mm256_add_ps(_mm256_mul_ps(si, _mm256_set1_ps(mx)), _mm256_mul_ps(ci, _mm256_set1_ps(mz)));
+                _mm256_storeu_ps(wx + i, _mm256_add_ps(_mm256_add_ps(_mm256_loadu_ps(px + i), _mm256_set1_ps(offset_x)), rx));
+                _mm256_storeu_ps(wy + i, _mm256_add_ps(_mm256_loadu_ps(py + i), _mm256_set1_ps(offset_y + my)));
+                _mm256_storeu_ps(wz + i, _mm256_add_ps(rz, _mm256_set1_ps(offset_z)));
+            }
+#endif
+#if defined(__SSE2__)
+            for (; i + 4 <= count; i += 4) {
+                __m128 ci = _mm_loadu_ps(c + i), si = _mm_loadu_ps(s + i);
+                __m128 rx = _mm_sub_ps(_mm_mul_ps(ci, _mm_set1_ps(mx)), _mm_mul_ps(si, _mm_set1_ps(mz)));
+                __m128 rz = _mm_add_ps(_mm_mul_ps(si, _mm_set1_ps(mx)), _mm_mul_ps(ci, _mm_set1_ps(mz)));
+                _mm_storeu_ps(wx + i, _mm_add_ps(_mm_add_ps(_mm_loadu_ps(px + i), _mm_set1_ps(offset_x)), rx));
+                _mm_storeu_ps(wy + i, _mm_add_ps(_mm_loadu_ps(py + i), _mm_set1_ps(offset_y + my)));
+                _mm_storeu_ps(wz + i, _mm_add_ps(rz, _mm_set1_ps(offset_z)));
+            }
+#endif
+            for (; i < count; i++) {
+                wx[i] = (px[i] + offset_x) + (c[i] * mx - s[i] * mz);
+                wy[i] = py[i] + (offset_y + my);
+                wz[i] = (s[i] * mx + c[i] * mz) + offset_z;
+            }
+        }
+    }
+};
+
+// The edges and triangles of "count" instances of a mesh, indexing the
+// corner-major vertices of CubeInstances::place.
+inline std::vector<std::pair<int, int>> instanceEdges(const std::vector<std::pair<int, int>>& edges, size_t count) {
+    std::vector<std::pair<int, int>> out;
+    out.reserve(edges.size() * count);
+    for (size_t i = 0; i < count; i++) {
+        for (const auto& e : edges) {
+            out.push_back({static_cast<int>(e.first * count + i), static_cast<int>(e.second * count + i)});
+        }
+    }
+    return out;
+}
+
+inline std::vector<std::array<int, 3>> instanceTriangles(const std::vector<std::array<int, 3>>& triangles,
+                                                         size_t count) {
+    std::vector<std::array<int, 3>> out;
+    out.reserve(triangles.size() * count);
+    for (size_t i = 0; i < count; i++) {
+        for (const auto& t : triangles) {
+            out.push_back({static_cast<int>(t[0] * count + i), static_cast<int>(t[1] * count + i),
+                           static_cast<int>(t[2] * count + i)});
+        }
+    }
+    return out;
+}
+
+#endif // INSTANCES_H
@@ -0,0 +1,492 @@
+// --- Line Rasterizers ---
+// Brute-Force, DDA and Bresenham from WEEK 3, plus the faster variants built
+// on them. All of them clip against target.clipRect() first (see Clip.h).
+#ifndef LINES_H
+#define LINES_H
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <utility>
+#include "Clip.h"
+#include "Gamma.h" // COVERAGE_FULL
+
+// --- Algorithm Selection ---
+enum class DrawAlgorithm {
+    BRUTE_FORCE,
+    DDA,
+    BRESENHAM,
+    RUN_SLICE,
+    DDA_FIXED,
+    WU
+};
+
+// --- Line ---
+struct Line {
+    int x1, y1, x2, y2;
+};
+
+
+// --- REVISED: Flexible Brute-Force Line Drawing Algorithm ---
+// This version respects the original x1,y1 -> x2,y2 direction.
+// Only the steps the clipping stage finds visible are drawn.
+template <typename Target>
+void drawLineBruteForce(Target& target, int x1, int y1, int x2, int y2) {
+    int dx = x2 - x1;
+    int dy = y2 - y1;
+    int first, last; // Range of visible steps, from the clipping stage
+
+    // Determine which axis has a larger range
+    if (std::abs(dx) > std::abs(dy)) {
+        // --- Iterate along the X-axis ---
+        float m = (float)dy / (float)dx;
+        int x_step = (dx > 0) ? 1 : -1;
+
+        // Each pixel is computed on its own, so the clipper can ask for any step
+        auto pixelAt = [&](int i) {
+            int current_x = x1 + i * x_step;
+            float y = y1 + m * (current_x - x1);
+            return std::make_pair(current_x, static_cast<int>(std::round(y)));
+        };
+        if (!clipLineSteps(target.clipRect(), std::abs(dx), pixelAt, first, last)) return;
+
+        int current_x = x1 + first * x_step;
+        int end_x = x1 + last * x_step;
+        while (true) {
+            float y = y1 + m * (current_x - x1);
+            target.plot(current_x, std::round(y));
+            
+            if (current_x == end_x) break; // Reached the last visible point
+            current_x += x_step;
+        }
+    } else {
+        // --- Iterate along the Y-axis ---
+        // Handle vertical lines separately to avoid division by zero
+        if (dy == 0) {
+            if (dx == 0 && computeOutCode(x1, y1, target.clipRect()) == CLIP_INSIDE) { // It's a single point
+                target.plot(x1, y1);
+            }
+            // If dx != 0, it's a horizontal line, handled by the other branch
+            return;
+        }
+
+        float m_inv = (float)dx / (float)dy;
+        int y_step = (dy > 0) ? 1 : -1;
+
+        auto pixelAt = [&](int i) {
+            int current_y = y1 + i * y_step;
+            float x = x1 + m_inv * (current_y - y1);
+            return std::make_pair(static_cast<int>(std::round(x)), current_y);
+        };
+        if (!clipLineSteps(target.clipRect(), std::abs(dy), pixelAt, first, last)) return;
+
+        int current_y = y1 + first * y_step;
+        int end_y = y1 + last * y_step;
+        while (true) {
+            float x = x1 + m_inv * (current_y - y1);
+            target.plot(std::round(x), current_y);
+            
+            if (current_y == end_y) break; // Reached the last visible point
+            current_y += y_step;
+        }
+    }
+}
+
+// --- WEEK 3: Digital Differential Analyzer (DDA) Algorithm ---
+// This version is more efficient than Brute-Force.
+// It removes multiplication from the loop by incrementally adding the slope.
+//
+// Clipping: when the line starts off screen, y is computed directly for the
+// first visible step. The running float sum can drift a tiny bit away from
+// the value the clipper computed, so the minor coordinate is also clamped to
+// the clip rectangle (the float DDA is the only algorithm that needs this).
+template <typename Target>
+void drawLineDDA(Target& target, int x1, int y1, int x2, int y2) {
+    int dx = x2 - x1;
+    int dy = y2 - y1;
+    const ClipRect rect = target.clipRect();
+    int first, last; // Range of visible steps, from the clipping stage
+
+    // Determine which axis has a larger range
+    if (std::abs(dx) > std::abs(dy)) {
+        // --- Iterate along the X-axis (Shallow Slope) ---
+        float m = (float)dy / (float)dx;
+        int x_step = (dx > 0) ? 1 : -1;
+
+        auto pixelAt = [&](int i) {
+            return std::make_pair(x1 + i * x_step, static_cast<int>(std::round(y1 + (m * x_step) * i)));
+        };
+        if (!clipLineSteps(rect, std::abs(dx), pixelAt, first, last)) return;
+
+        float y = (float)y1 + (m * x_step) * first; // Start y as a float
+        int x = x1 + first * x_step;
+        int end_x = x1 + last * x_step;
+
+        while (true) {
+            int py = std::min(std::max(static_cast<int>(std::round(y)), rect.ymin), rect.ymax);
+            target.plot(x, py);
+            if (x == end_x) break; // Reached the last visible point
+            
+            x += x_step;
+            y += (m * x_step); // The core DDA step: y = y + m
+        }
+    } else {
+        // --- Iterate along the Y-axis (Steep Slope) ---
+        if (dy == 0) { // Handle horizontal lines
+            if (dx == 0 && computeOutCode(x1, y1, rect) == CLIP_INSIDE) { target.plot(x1, y1); }
+            return;
+        }
+
+        float m_inv = (float)dx / (float)dy;
+        int y_step = (dy > 0) ? 1 : -1;
+
+        auto pixelAt = [&](int i) {
+            return std::make_pair(static_cast<int>(std::round(x1 + (m_inv * y_step) * i)), y1 + i * y_step);
+        };
+        if (!clipLineSteps(rect, std::abs(dy), pixelAt, first, last)) return;
+
+        float x = (float)x1 + (m_inv * y_step) * first; // Start x as a float
+        int y = y1 + first * y_step;
+        int end_y = y1 + last * y_step;
+
+        while (true) {
+            int px = std::min(std::max(static_cast<int>(std::round(x)), rect.xmin), rect.xmax);
+            target.plot(px, y);
+            if (y == end_y) break; // Reached the last visible point
+            
+            y += y_step;
+            x += (m_inv * y_step); // The core DDA step: x = x + (1/m)
+        }
+    }
+}
+
+
+// --- Fixed-Point DDA Algorithm ---
+// Same incremental structure as drawLineDDA, but the coordinate that moves
+// by the slope is kept as a fixed-point integer: the low DDA_FRACTION_BITS
+// bits hold the fraction. No float math and no round() in the loop.
+//
+// Rounding: the start value gets +0.5, so cutting off the fraction (>>)
+// rounds to nearest. The slope is rounded *up*, which means we can only
+// ever be a tiny bit above the exact value, never below it. With 32
+// fraction bits that error stays under one half-pixel step for lines up
+// to 46340 pixels long, so every pixel is exactly round(y1 + i * dy / dx),
+// with ties rounding up. 16 fraction bits would only be exact up to ~180.
+const int DDA_FRACTION_BITS = 32;
+const int64_t DDA_ONE = int64_t(1) << DDA_FRACTION_BITS;
+
+// Integer division that rounds up, for b > 0 and any sign of a.
+inline int64_t ceilDiv(int64_t a, int64_t b) {
+    return (a >= 0) ? (a + b - 1) / b : -((-a) / b);
+}
+
+template <typename Target>
+void drawLineDDAFixed(Target& target, int x1, int y1, int x2, int y2) {
+    int dx = x2 - x1;
+    int dy = y2 - y1;
+    int first, last; // Range of visible steps, from the clipping stage
+
+    // Determine which axis has a larger range
+    if (std::abs(dx) > std::abs(dy)) {
+        // --- Iterate along the X-axis (Shallow Slope) ---
+        int x_step = (dx > 0) ? 1 : -1;
+        int64_t m = ceilDiv(dy * DDA_ONE, std::abs(dx)); // Change in y per x_step
+        int64_t y_start = y1 * DDA_ONE + DDA_ONE / 2; // Start y (+0.5 for rounding)
+
+        // Step i is exactly y_start + i * m, so clipping loses nothing.
+        auto pixelAt = [&](int i) {
+            return std::make_pair(x1 + i * x_step, static_cast<int>((y_start + i * m) >> DDA_FRACTION_BITS));
+        };
+        if (!clipLineSteps(target.clipRect(), std::abs(dx), pixelAt, first, last)) return;
+
+        int64_t y = y_start + first * m;
+        int x = x1 + first * x_step;
+        int end_x = x1 + last * x_step;
+
+        while (true) {
+            target.plot(x, static_cast<int>(y >> DDA_FRACTION_BITS));
+            if (x == end_x) break; // Reached the last visible point
+
+            x += x_step;
+            y += m; // The core DDA step, in integers
+        }
+    } else {
+        // --- Iterate along the Y-axis (Steep Slope) ---
+        if (dy == 0) { // Handle horizontal lines
+            if (dx == 0 && computeOutCode(x1, y1, target.clipRect()) == CLIP_INSIDE) { target.plot(x1, y1); }
+            return;
+        }
+
+        int y_step = (dy > 0) ? 1 : -1;
+        int64_t m_inv = ceilDiv(dx * DDA_ONE, std::abs(dy)); // Change in x per y_step
+        int64_t x_start = x1 * DDA_ONE + DDA_ONE / 2; // Start x (+0.5 for rounding)
+
+        auto pixelAt = [&](int i) {
+            return std::make_pair(static_cast<int>((x_start + i * m_inv) >> DDA_FRACTION_BITS), y1 + i * y_step);
+        };
+        if (!clipLineSteps(target.clipRect(), std::abs(dy), pixelAt, first, last)) return;
+
+        int64_t x = x_start + first * m_inv;
+        int y = y1 + first * y_step;
+        int end_y = y1 + last * y_step;
+
+        while (true) {
+            target.plot(static_cast<int>(x >> DDA_FRACTION_BITS), y);
+            if (y == end_y) break; // Reached the last visible point
+
+            y += y_step;
+            x += m_inv;
+        }
+    }
+}
+
+
+// --- WEEK 3: Generalized Bresenham's Line Algorithm ---
+// This version is the most efficient.
+// It works for all 8 octants (any slope) using only integer math.
+template <typename Target>
+void drawLineBresenham(Target& target, int x1, int y1, int x2, int y2) {
+    // TRICK 1: Handle "steep" lines by pretending they are "shallow".
+    // A steep line is one where the change in Y is greater than the change in X.
+    const bool is_steep = std::abs(y2 - y1) > std::abs(x2 - x1);
+    if (is_steep) {
+        // If it's steep, we swap the x and y coordinates. This reflects the line
+        // across the y=x axis, turning it into a shallow line.
+        std::swap(x1, y1);
+        std::swap(x2, y2);
+    }
+
+    // TRICK 2: Always draw from left-to-right.
+    // This simplifies our loop so we can always do `x++`.
+    if (x1 > x2) {
+        // If the starting point is to the right of the end point, swap them.
+        std::swap(x1, x2);
+        std::swap(y1, y2);
+    }
+
+    // Now, we can do the core Bresenham calculation.
+    const int dx = x2 - x1;
+    const int dy = std::abs(y2 - y1);
+    
+    // We need to know if y should be incrementing or decrementing.
+    const int y_step = (y1 < y2) ? 1 : -1;
+
+    // TRICK 3: Clipping without changing the line.
+    // Starting with error = dx / 2, after i steps y has moved
+    // (i * dy + dx - 1 - dx / 2) / dx times. That lets the clipper jump
+    // straight to any step and lets us resume the loop there with exactly
+    // the error term the full loop would have had.
+    const int half = dx / 2;
+    auto yMovesAt = [&](int i) -> int64_t {
+        return (dx == 0) ? 0 : (int64_t(i) * dy + dx - 1 - half) / dx;
+    };
+    auto pixelAt = [&](int i) {
+        int x = x1 + i;
+        int y = y1 + y_step * static_cast<int>(yMovesAt(i));
+        return is_steep ? std::make_pair(y, x) : std::make_pair(x, y);
+    };
+    int first, last;
+    if (!clipLineSteps(target.clipRect(), dx, pixelAt, first, last)) return;
+
+    // This is the "error term" or "decision parameter". It keeps track of
+    // how far our pixel line has drifted from the true mathematical line.
+    const int64_t moves = yMovesAt(first);
+    int error = static_cast<int>(half - int64_t(first) * dy + moves * dx);
+    int y = y1 + y_step * static_cast<int>(moves);
+
+    // Loop through every visible x from the start to the end.
+    for (int x = x1 + first; x <= x1 + last; x++) {
+        // Draw the pixel.
+        // IMPORTANT: If we swapped coordinates earlier (for a steep line),
+        // we must "un-swap" them here, right before drawing.
+        if (is_steep) {
+            target.plot(y, x);
+        } else {
+            target.plot(x, y);
+        }
+
+        // Update the error term. Each step in x adds to the error.
+        error -= dy;
+
+        // Check if the error has crossed the threshold.
+        if (error < 0) {
+            // If it has, it's time to step in the y direction to correct it.
+            y += y_step;
+            // And we reset the error by adding dx back.
+            error += dx;
+        }
+    }
+}
+
+
+// --- Run-Slice Bresenham Line Algorithm ---
+// Plain Bresenham decides one pixel at a time, but on a shallow line most of
+// those decisions are just "keep going in x". A run-slice line instead works
+// out how long each horizontal run is and hands the whole run to the target
+// as one span. It visits exactly the pixels drawLineBresenham visits.
+template <typename Target>
+void drawLineRunSlice(Target& target, int x1, int y1, int x2, int y2) {
+    // Same normalization as drawLineBresenham: make the line shallow and
+    // left-to-right, so runs are along x and y moves by at most 1 per run.
+    const bool is_steep = std::abs(y2 - y1) > std::abs(x2 - x1);
+    if (is_steep) {
+        std::swap(x1, y1);
+        std::swap(x2, y2);
+    }
+    if (x1 > x2) {
+        std::swap(x1, x2);
+        std::swap(y1, y2);
+    }
+
+    const int dx = x2 - x1;
+    const int dy = std::abs(y2 - y1);
+    const int y_step = (y1 < y2) ? 1 : -1;
+    const int half = dx / 2;
+
+    // Same step -> pixel mapping as drawLineBresenham, for the clipper.
+    auto yMovesAt = [&](int i) -> int64_t {
+        return (dx == 0) ? 0 : (int64_t(i) * dy + dx - 1 - half) / dx;
+    };
+    auto pixelAt = [&](int i) {
+        int x = x1 + i;
+        int y = y1 + y_step * static_cast<int>(yMovesAt(i));
+        return is_steep ? std::make_pair(y, x) : std::make_pair(x, y);
+    };
+    int first, last;
+    if (!clipLineSteps(target.clipRect(), dx, pixelAt, first, last)) return;
+    const int x_end = x1 + last;
+
+    // A perfectly flat line is one single run.
+    if (dy == 0) {
+        if (is_steep) {
+            target.vspan(y1, x1 + first, x_end);
+        } else {
+            target.hspan(x1 + first, x_end, y1);
+        }
+        return;
+    }
+
+    // Bresenham stays on row "moves" until step (moves * dx + dx / 2) / dy,
+    // which gives the (possibly clipped) first run. Without clipping this is
+    // just (dx / 2) / dy + 1 pixels.
+    const int64_t moves = yMovesAt(first);
+    const int64_t run_last_step = (moves * dx + half) / dy;
+    int run = static_cast<int>(run_last_step - first + 1);
+
+    // After that, each run is either dx / dy or dx / dy + 1 pixels long.
+    // The leftover dx % dy piles up in "fraction" and every time it reaches
+    // dy we get one of the longer runs, exactly where Bresenham would.
+    const int whole = dx / dy;
+    const int remainder = dx % dy;
+    int fraction = static_cast<int>(half - (run_last_step + 1) * dy + moves * dx + dy);
+
+    int x = x1 + first;
+    int y = y1 + y_step * static_cast<int>(moves);
+    while (true) {
+        int run_end = std::min(x + run - 1, x_end); // The last run may be cut short
+        if (is_steep) {
+            target.vspan(y, x, run_end);
+        } else {
+            target.hspan(x, run_end, y);
+        }
+        if (run_end == x_end) break; // Reached the last visible point
+
+        x = run_end + 1;
+        y += y_step;
+        fraction += remainder;
+        if (fraction >= dy) {
+            fraction -= dy;
+            run = whole + 1;
+        } else {
+            run = whole;
+        }
+    }
+}
+
+
+// --- Xiaolin Wu's Anti-Aliased Line ---
+// Instead of picking one pixel per step, Wu's algorithm lights the two
+// pixels on either side of the real line, each weighted by how close the
+// line passes to it. Targets receive these as plotCoverage(x, y, coverage),
+// with coverage from 0 to COVERAGE_FULL: the framebuffer blends them
+// (Gamma.h), the X targets can only switch a pixel on or off.
+//
+// The minor coordinate is the fixed-point value from drawLineDDAFixed,
+// just without the +0.5: its integer part is the first pixel of the pair,
+// and the top 8 fraction bits are the coverage of the second one. Since the
+// two coverages always add up to COVERAGE_FULL there is no division at all.
+template <typename Target>
+void drawLineWu(Target& target, int x1, int y1, int x2, int y2) {
+    // Same trick as Bresenham: work on a shallow line going right.
+    const bool is_steep = std::abs(y2 - y1) > std::abs(x2 - x1);
+    if (is_steep) {
+        std::swap(x1, y1);
+        std::swap(x2, y2);
+    }
+    if (x1 > x2) {
+        std::swap(x1, x2);
+        std::swap(y1, y2);
+    }
+
+    const int dx = x2 - x1;
+    const int dy = y2 - y1;
+    const int64_t m = (dx == 0) ? 0 : ceilDiv(dy * DDA_ONE, dx); // Change in y per step
+    const int64_t y_start = y1 * DDA_ONE;
+
+    // Clip on the first pixel of each pair. The rectangle is grown by one
+    // row (column if steep) on the minor axis, so steps whose second pixel
+    // is the only one inside are kept; the minor bounds are checked below.
+    const ClipRect rect = target.clipRect();
+    const ClipRect search = is_steep ? ClipRect{rect.xmin - 1, rect.ymin, rect.xmax, rect.ymax}
+                                     : ClipRect{rect.xmin, rect.ymin - 1, rect.xmax, rect.ymax};
+    const int minor_min = is_steep ? rect.xmin : rect.ymin;
+    const int minor_max = is_steep ? rect.xmax : rect.ymax;
+    auto pixelAt = [&](int i) {
+        int x = x1 + i;
+        int y = static_cast<int>((y_start + i * m) >> DDA_FRACTION_BITS);
+        return is_steep ? std::make_pair(y, x) : std::make_pair(x, y);
+    };
+    int first, last;
+    if (!clipLineSteps(search, dx, pixelAt, first, last)) return;
+
+    int64_t y = y_start + first * m;
+    for (int x = x1 + first; x <= x1 + last; x++, y += m) {
+        int py = static_cast<int>(y >> DDA_FRACTION_BITS);
+        int second = static_cast<int>((y >> (DDA_FRACTION_BITS - 8)) & 0xFF); // Coverage of py + 1
+        if (py >= minor_min) {
+            if (is_steep) {
+                target.plotCoverage(py, x, COVERAGE_FULL - second);
+            } else {
+                target.plotCoverage(x, py, COVERAGE_FULL - second);
+            }
+        }
+        if (second != 0 && py + 1 <= minor_max) {
+            if (is_steep) {
+                target.plotCoverage(py + 1, x, second);
+            } else {
+                target.plotCoverage(x, py + 1, second);
+            }
+        }
+    }
+}
+
+
+// Picks the line algorithm selected with the F/D/I/B/S/W keys.
+template <typename Target>
+void drawLine(Target& target, DrawAlgorithm algo, int x1, int y1, int x2, int y2) {
+    if (algo == DrawAlgorithm::WU) {
+        drawLineWu(target, x1, y1, x2, y2);
+    } else if (algo == DrawAlgorithm::DDA_FIXED) {
+        drawLineDDAFixed(target, x1, y1, x2, y2);
+    } else if (algo == DrawAlgorithm::RUN_SLICE) {
+        drawLineRunSlice(target, x1, y1, x2, y2);
+    } else if (algo == DrawAlgorithm::BRESENHAM) {
+        drawLineBresenham(target, x1, y1, x2, y2);
+    } else if (algo == DrawAlgorithm::DDA) {
+        drawLineDDA(target, x1, y1, x2, y2);
+    } else { // Default to Brute-Force
+        drawLineBruteForce(target, x1, y1, x2, y2);
+    }
+}
+
+#endif // LINES_H
@@ -0,0 +1,277 @@
+// --- Wavefront OBJ Loader ---
+// Loads a mesh from an .obj file: its vertices ("v x y z") and faces
+// ("f 1 2 3 ...", also "f 1/4/2 ..." and negative, relative indices), the
+// faces fanned into triangles and cut into edges for drawEdges. Everything
+// else (normals, texture coordinates, groups, materials) is skipped.
+//
+// Big meshes have millions of lines, so the parser avoids the usual costs:
+//   - the file is memory-mapped, and parsed straight from the mapping,
+//   - numbers are read by hand from the bytes (no iostream, no strtof, no
+//     std::string per token),
+//   - a quick first pass counts the "v" and "f" lines, so every array is
+//     allocated once at its final size.
+// Faces share their edges with their neighbours, so the edges go through
+// a hash set (EdgeBuilder.h) that keeps each one once.
+#ifndef OBJ_LOADER_H
+#define OBJ_LOADER_H
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "EdgeBuilder.h"
+#include "Transform.h" // VertexArray
+
+struct ObjMesh {
+    VertexArray vertices;
+    std::vector<std::array<int, 3>> triangles; // Faces fanned out from their first corner
+    std::vector<std::pair<int, int>> edges;    // Each edge once, lower index first, in face order
+    size_t faces = 0;
+    size_t bytes = 0;          // Size of the parsed text
+    double parse_seconds = 0.0; // Parsing and edge extraction, without reading the file
+
+    double megabytesPerSecond() const {
+        return parse_seconds > 0.0 ? bytes / parse_seconds / 1e6 : 0.0;
+    }
+};
+
+// --- Number Parsing ---
+// Both return the position after the number, or nullptr if there is none.
+inline const char* parseObjInt(const char* p, const char* end, long& out) {
+    bool negative = p < end && *p == '-';
+    if (p < end && (*p == '-' || *p == '+')) {
+        p++;
+    }
+    if (p == end || *p < '0' || *p > '9') {
+        return nullptr;
+    }
+    long value = 0;
+    for (; p < end && *p >= '0' && *p <= '9'; p++) {
+        if (value <= (LONG_MAX - 9) / 10) {
+            value = value * 10 + (*p - '0');
+        } else {
+            value = LONG_MAX; // Too long for any index or exponent: the callers refuse or clamp it
+        }
+    }
+    out = negative ? -value : value;
+    return p;
+}
+
+// Decimal numbers with an optional exponent ("-1.5", ".25", "3e-2"). The
+// digits are gathered as one integer and scaled once at the end, which is
+// exact to float precision for anything an exporter writes.
+inline const char* parseObjFloat(const char* p, const char* end, float& out) {
+    bool negative = p < end && *p == '-';
+    if (p < end && (*p == '-' || *p == '+')) {
+        p++;
+    }
+    uint64_t mantissa = 0;
+    int exponent = 0, digits = 0;
+    for (; p < end && *p >= '0' && *p <= '9'; p++, digits++) {
+        if (mantissa < 100000000000000000ULL) {
+            mantissa = mantissa * 10 + (*p - '0');
+        } else {
+            exponent++; // Past 17 digits the rest cannot change a float
+        }
+    }
+    if (p < end && *p == '.') {
+        for (p++; p < end && *p >= '0' && *p <= '9'; p++, digits++) {
+            if (mantissa < 100000000000000000ULL) {
+                mantissa = mantissa * 10 + (*p - '0');
+                exponent--;
+            }
+        }
+    }
+    if (digits == 0) {
+        return nullptr;
+    }
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        long e;
+        const char* after = parseObjInt(p + 1, end, e);
+        if (!after) {
+            return nullptr;
+        }
+        exponent += static_cast<int>(std::max(-400L, std::min(400L, e)));
+        p = after;
+    }
+    double value = static_cast<double>(mantissa);
+    static const double POWERS[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+    for (; exponent > 22; exponent -= 22) {
+        value *= 1e22;
+    }
+    for (; exponent < -22; exponent += 22) {
+        value /= 1e22;
+    }
+    value = exponent >= 0 ? value * POWERS[exponent] : value / POWERS[-exponent];
+    out = static_cast<float>(negative ? -value : value);
+    return p;
+}
+
+inline const char* skipObjBlanks(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) {
+        p++;
+    }
+    return p;
+}
+
+// --- Parsing ---
+// Parses OBJ text that is already in memory. On failure returns false with
+// the line and reason in "error".
+inline bool parseObj(const char* data, size_t size, ObjMesh& mesh, std::string& error) {
+    auto start = std::chrono::steady_clock::now();
+    const char* const end = data + size;
+    mesh = ObjMesh();
+    mesh.bytes = size;
+
+    // First pass: count vertices and face corners, to allocate once
+    size_t vertex_lines = 0, face_lines = 0, face_corners = 0;
+    for (const char* p = data; p < end;) {
+        const char* line_end = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        line_end = line_end ? line_end : end;
+        p = skipObjBlanks(p, line_end);
+        if (line_end - p > 1 && (p[1] == ' ' || p[1] == '\t')) {
+            if (p[0] == 'v') {
+                vertex_lines++;
+            } else if (p[0] == 'f') {
+                face_lines++;
+                for (const char* q = p + 1; q < line_end; q++) {
+                    face_corners += (q[-1] == ' ' || q[-1] == '\t') && q[0] != ' ' && q[0] != '\t' && q[0] != '\r';
+                }
+            }
+        }
+        p = line_end + 1;
+    }
+    mesh.vertices.x.reserve(vertex_lines);
+    mesh.vertices.y.reserve(vertex_lines);
+    mesh.vertices.z.reserve(vertex_lines);
+    mesh.triangles.reserve(face_corners > 2 * face_lines ? face_corners - 2 * face_lines : 0);
+    EdgeSet<int> edges;
+    edges.reserve(face_corners / 2); // Each edge shared by two faces, in a closed mesh
+
+    std::vector<int> corners; // One face's vertex indices, reused for every face
+    size_t line_number = 0;
+    for (const char* p = data; p < end;) {
+        line_number++;
+        const char* line_end = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        line_end = line_end ? line_end : end;
+        p = skipObjBlanks(p, line_end);
+        const bool keyword = line_end - p > 1 && (p[1] == ' ' || p[1] == '\t');
+
+        if (keyword && p[0] == 'v') {
+            float xyz[3];
+            p += 2;
+            for (float& c : xyz) {
+                p = parseObjFloat(skipObjBlanks(p, line_end), line_end, c);
+                if (!p) {
+                    error = "line " + std::to_string(line_number) + ": a vertex needs three numbers";
+                    return false;
+                }
+            }
+            mesh.vertices.x.push_back(xyz[0]);
+            mesh.vertices.y.push_back(xyz[1]);
+            mesh.vertices.z.push_back(xyz[2]);
+        } else if (keyword && p[0] == 'f') {
+            corners.clear();
+            const long vertex_count = static_cast<long>(mesh.vertices.x.size());
+            // Up to the end of the line or a trailing "# comment"
+            for (p = skipObjBlanks(p + 2, line_end); p < line_end && *p != '#'; p = skipObjBlanks(p, line_end)) {
+                long index = 0;
+                p = parseObjInt(p, line_end, index);
+                // 1-based, or counted back from the last vertex read so far
+                long resolved = index > 0 ? index - 1 : vertex_count + index;
+                if (!p || index == 0 || resolved < 0 || resolved >= vertex_count) {
+                    error = "line " + std::to_string(line_number) + ": bad vertex index in a face";
+                    return false;
+                }
+                corners.push_back(static_cast<int>(resolved));
+                while (p < line_end && *p != ' ' && *p != '\t' && *p != '\r') {
+                    p++; // The /texture/normal part
+                }
+            }
+            if (corners.size() < 3) {
+                error = "line " + std::to_string(line_number) + ": a face needs at least three corners";
+                return false;
+            }
+            mesh.faces++;
+            edges.addFace(corners.data(), corners.size());
+            for (size_t i = 1; i + 1 < corners.size(); i++) {
+                mesh.triangles.push_back({corners[0], corners[i], corners[i + 1]});
+            }
+        }
+        p = line_end + 1;
+    }
+
+    mesh.edges = edges.take();
+    mesh.parse_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return true;
+}
+
+// Maps the file into memory and parses it.
+inline bool loadObj(const std::string& path, ObjMesh& mesh, std::string& error) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        error = "cannot open " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        error = path + " is empty or unreadable";
+        close(fd);
+        return false;
+    }
+    size_t size = static_cast<size_t>(info.st_size);
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // The mapping keeps the file open
+    if (mapping == MAP_FAILED) {
+        error = "cannot map " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    madvise(mapping, size, MADV_SEQUENTIAL);
+    bool ok = parseObj(static_cast<const char*>(mapping), size, mesh, error);
+    munmap(mapping, size);
+    return ok;
+}
+
+// Centers the mesh on the origin and scales it so its largest side is
+// "size" model units, ready to be placed like the cube and the spine.
+// OBJ's y axis points up and ours down, so y is flipped. That also turns
+// faces wound counter-clockwise seen from outside (OBJ's rule) clockwise,
+// so the triangles are turned around to match the cube's faces, which
+// writeTriangleDepth relies on to skip the ones facing away.
+inline void fitObjMesh(ObjMesh& mesh, float size) {
+    VertexArray& v = mesh.vertices;
+    if (v.x.empty()) {
+        return;
+    }
+    float lo[3] = {v.x[0], v.y[0], v.z[0]}, hi[3] = {v.x[0], v.y[0], v.z[0]};
+    for (size_t i = 0; i < v.x.size(); i++) {
+        const float p[3] = {v.x[i], v.y[i], v.z[i]};
+        for (int k = 0; k < 3; k++) {
+            lo[k] = std::min(lo[k], p[k]);
+            hi[k] = std::max(hi[k], p[k]);
+        }
+    }
+    float extent = std::max({hi[0] - lo[0], hi[1] - lo[1], hi[2] - lo[2]});
+    float scale = extent > 0.0f ? size / extent : 1.0f;
+    for (size_t i = 0; i < v.x.size(); i++) {
+        v.x[i] = (v.x[i] - (lo[0] + hi[0]) / 2) * scale;
+        v.y[i] = -(v.y[i] - (lo[1] + hi[1]) / 2) * scale;
+        v.z[i] = (v.z[i] - (lo[2] + hi[2]) / 2) * scale;
+    }
+    for (auto& t : mesh.triangles) {
+        std::swap(t[1], t[2]);
+    }
+}
+
+#endif // OBJ_LOADER_H
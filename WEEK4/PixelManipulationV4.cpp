@@ -6,299 +6,503 @@
 #include <utility>
 #include <X11/Xutil.h> // For XLookupString and KeySym
 #include <string>      // For std::string
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <X11/extensions/XShm.h> // MIT-SHM, link with -lXext
+#include <X11/extensions/Xdbe.h> // Double buffer extension, also in -lXext
+#include "Clip.h"
+#include "Framebuffer.h"
+#include "Lines.h"
+#include "Circles.h"
+#include "Transform.h"
+#include "Scene.h"
+#include "TileRenderer.h"
+#include "Checks.h"
+#include "DirtyRects.h"
+#include "StaticLayer.h"
+#include "FrameScheduler.h"
+#include "ObjLoader.h"
+#include "Collisions.h"
 
 using namespace std;
 
-// Algorithm Selection: DAA or Bresenham
-enum class DrawAlgorithm {
-    BRUTE_FORCE,
-    DDA,
-    BRESENHAM
-};
-
 enum class DrawMode {
     LINE,
-    CIRCLE
+    CIRCLE,
+    ELLIPSE,
+    POLYGON
 };
 
-// Struct definitions remain the same
-struct Line {
-    int x1, y1, x2, y2;
+// Render Backend Selection
+// XLIB_POINTS is the original path: every plotted pixel is its own XDrawPoint request.
+// XLIB_BATCHED collects pixels into an XPoint buffer and sends them with XDrawPoints.
+// FRAMEBUFFER rasterizes into a CPU-side 32-bit buffer and uploads it once per frame.
+enum class RenderBackend {
+    XLIB_POINTS,
+    XLIB_BATCHED,
+    FRAMEBUFFER
 };
 
-struct Circle {
-    int cx, cy, radius;
+// Presentation Selection (--present on the command line)
+// DIRECT draws straight into the visible window, so half-finished frames can show.
+// PIXMAP draws into an off-screen Pixmap and copies the damaged rectangles to the window.
+// DBE draws into the Double Buffer Extension's back buffer and swaps it in.
+enum class PresentMode {
+    DIRECT,
+    PIXMAP,
+    DBE
 };
 
-struct Point3D {
-    float x, y, z;
-};
+// --- X11 Render Targets ---
+// The rasterizers draw through a "Target" (see Framebuffer.h for the
+// interface and the in-memory framebuffer). These two send the pixels
+// straight to the X server instead.
+
+// Original path: one XDrawPoint request per pixel.
+// Spans become a single zero-width XDrawLine, which for a horizontal or
+// vertical line covers exactly the pixels from one end to the other.
+struct XPointTarget {
+    Display* display;
+    Drawable drawable;
+    GC gc;
+    ClipRect clip;
+
+    ClipRect clipRect() const {
+        return clip;
+    }
 
-struct EdgeBuilder {
-    static vector<pair<int, int>> build(const vector<Point3D>& vertices) {
-        vector<pair<int, int>> edges;
-        for (size_t i = 0; i < vertices.size() - 1; ++i) {
-            edges.push_back({static_cast<int>(i), static_cast<int>(i + 1)});
+    void plot(int x, int y) {
+        XDrawPoint(display, drawable, gc, x, y);
+    }
+
+    // A GC draws in one solid color, so anti-aliasing turns into a threshold.
+    void plotCoverage(int x, int y, int coverage) {
+        if (coverage * 2 >= COVERAGE_FULL) {
+            plot(x, y);
         }
-        return edges;
     }
-};
 
-// Object definitions remain the same
-const vector<Point3D> cube_vertices = {
-    {-20, -20, -20}, {20, -20, -20}, {20, 20, -20}, {-20, 20, -20},
-    {-20, -20, 20},  {20, -20, 20},  {20, 20, 20},  {-20, 20, 20}
-};
-const vector<pair<int, int>> cube_edges = {
-    {0, 1}, {1, 2}, {2, 3}, {3, 0}, {4, 5}, {5, 6}, {6, 7}, {7, 4},
-    {0, 4}, {1, 5}, {2, 6}, {3, 7}
-};
-const vector<Point3D> rayquaza_spine_vertices = {
-    {  0,   0,   0}, { 20,   5, -10}, { 30,  15, -20}, { 25,  30, -30}, { 10,  40, -40},
-    {-10,  35, -50}, {-20,  20, -60}, {-15,   5, -70}, {  0,   0, -80}, { 10,  -5, -90},
-    { 20, -10, -100},{ 15, -20, -110},{  0, -25, -120},{-10, -20, -130},{-20, -15, -140}
+    void hspan(int x1, int x2, int y) {
+        XDrawLine(display, drawable, gc, x1, y, x2, y);
+    }
+
+    void vspan(int x, int y1, int y2) {
+        XDrawLine(display, drawable, gc, x, y1, x, y2);
+    }
 };
-const vector<pair<int, int>> rayquaza_spine_edges = EdgeBuilder::build(rayquaza_spine_vertices);
-
-
-// --- REVISED: Flexible Brute-Force Line Drawing Algorithm ---
-// This version respects the original x1,y1 -> x2,y2 direction.
-void drawLineBruteForce(Display* display, Window window, GC gc, int x1, int y1, int x2, int y2) {
-    int dx = x2 - x1;
-    int dy = y2 - y1;
-
-    // Determine which axis has a larger range
-    if (abs(dx) > abs(dy)) {
-        // --- Iterate along the X-axis ---
-        float m = (float)dy / (float)dx;
-        int x_step = (dx > 0) ? 1 : -1;
-        
-        int current_x = x1;
-        while (true) {
-            float y = y1 + m * (current_x - x1);
-            XDrawPoint(display, window, gc, current_x, round(y));
-            
-            if (current_x == x2) break; // Reached the end point
-            current_x += x_step;
-        }
-    } else {
-        // --- Iterate along the Y-axis ---
-        // Handle vertical lines separately to avoid division by zero
-        if (dy == 0) {
-            if (dx == 0) { // It's a single point
-                XDrawPoint(display, window, gc, x1, y1);
-            }
-            // If dx != 0, it's a horizontal line, handled by the other branch
-            return;
+
+// Batched path: pixels are queued in an XPoint buffer and sent with
+// XDrawPoints, spans in an XSegment buffer sent with XDrawSegments. The
+// buffers are sized once to the largest request the server accepts, so each
+// flush is exactly one request and they are reused frame after frame
+// without reallocating. All primitives share one GC, so the order in which
+// points and segments reach the server does not change the image.
+struct XPointBatchTarget {
+    Display* display = nullptr;
+    Drawable drawable = 0;
+    GC gc = 0;
+    ClipRect clip = {0, 0, 0, 0};
+    vector<XPoint> points;
+    vector<XSegment> segments;
+    size_t point_capacity = 0;
+    size_t segment_capacity = 0;
+
+    void init(Display* dpy, int width, int height) {
+        display = dpy;
+        clip = {0, 0, width - 1, height - 1};
+        // XMaxRequestSize is in 4-byte units. Both requests have a 3 unit
+        // header (opcode/length, drawable, gc), then 1 unit per XPoint or
+        // 2 units per XSegment.
+        point_capacity = XMaxRequestSize(display) - 3;
+        segment_capacity = (XMaxRequestSize(display) - 3) / 2;
+        points.reserve(point_capacity);
+        segments.reserve(segment_capacity);
+    }
+
+    void begin(Drawable target_drawable, GC target_gc) {
+        drawable = target_drawable;
+        gc = target_gc;
+        points.clear();
+        segments.clear();
+    }
+
+    ClipRect clipRect() const {
+        return clip;
+    }
+
+    void plot(int x, int y) {
+        points.push_back({static_cast<short>(x), static_cast<short>(y)});
+        if (points.size() == point_capacity) {
+            flushPoints();
         }
+    }
 
-        float m_inv = (float)dx / (float)dy;
-        int y_step = (dy > 0) ? 1 : -1;
-        
-        int current_y = y1;
-        while (true) {
-            float x = x1 + m_inv * (current_y - y1);
-            XDrawPoint(display, window, gc, round(x), current_y);
-            
-            if (current_y == y2) break; // Reached the end point
-            current_y += y_step;
+    void plotCoverage(int x, int y, int coverage) {
+        if (coverage * 2 >= COVERAGE_FULL) {
+            plot(x, y);
         }
     }
-}
 
-// --- WEEK 3: Digital Differential Analyzer (DDA) Algorithm ---
-// This version is more efficient than Brute-Force.
-// It removes multiplication from the loop by incrementally adding the slope.
-void drawLineDDA(Display* display, Window window, GC gc, int x1, int y1, int x2, int y2) {
-    int dx = x2 - x1;
-    int dy = y2 - y1;
-
-    // Determine which axis has a larger range
-    if (abs(dx) > abs(dy)) {
-        // --- Iterate along the X-axis (Shallow Slope) ---
-        float m = (float)dy / (float)dx;
-        int x_step = (dx > 0) ? 1 : -1;
-        
-        float y = (float)y1; // Start y as a float
-        int x = x1;
-        
-        while (true) {
-            XDrawPoint(display, window, gc, x, round(y));
-            if (x == x2) break; // Reached the end point
-            
-            x += x_step;
-            y += (m * x_step); // The core DDA step: y = y + m
-        }
-    } else {
-        // --- Iterate along the Y-axis (Steep Slope) ---
-        if (dy == 0) { // Handle horizontal lines
-            if (dx == 0) { XDrawPoint(display, window, gc, x1, y1); }
-            return;
+    void hspan(int x1, int x2, int y) {
+        addSegment(x1, y, x2, y);
+    }
+
+    void vspan(int x, int y1, int y2) {
+        addSegment(x, y1, x, y2);
+    }
+
+    void addSegment(int x1, int y1, int x2, int y2) {
+        segments.push_back({static_cast<short>(x1), static_cast<short>(y1),
+                            static_cast<short>(x2), static_cast<short>(y2)});
+        if (segments.size() == segment_capacity) {
+            flushSegments();
         }
+    }
 
-        float m_inv = (float)dx / (float)dy;
-        int y_step = (dy > 0) ? 1 : -1;
-        
-        float x = (float)x1; // Start x as a float
-        int y = y1;
+    void flushPoints() {
+        if (!points.empty()) {
+            XDrawPoints(display, drawable, gc, points.data(), points.size(), CoordModeOrigin);
+            points.clear();
+        }
+    }
 
-        while (true) {
-            XDrawPoint(display, window, gc, round(x), y);
-            if (y == y2) break; // Reached the end point
-            
-            y += y_step;
-            x += (m_inv * y_step); // The core DDA step: x = x + (1/m)
+    void flushSegments() {
+        if (!segments.empty()) {
+            XDrawSegments(display, drawable, gc, segments.data(), segments.size());
+            segments.clear();
         }
     }
-}
 
+    void flush() {
+        flushPoints();
+        flushSegments();
+    }
+};
+
+// --- Pixmap Static Layer ---
+// The X backends' version of the retained layer (see StaticLayer.h): an
+// off-screen Pixmap on the server that holds the user's shapes. Both X
+// backends draw the same pixels, so they share it; whichever is active
+// does the drawing, so its cost still shows when the layer is rebuilt.
+struct PixmapLayer {
+    Display* display = nullptr;
+    Pixmap pixmap = 0;
+    GC gc = 0;
+    int width = 0, height = 0;
+    unsigned long background = 0;
+    LayerState state;
+
+    void init(Display* dpy, Drawable window, int screen, int w, int h) {
+        display = dpy;
+        width = w;
+        height = h;
+        background = WhitePixel(display, screen);
+        pixmap = XCreatePixmap(display, window, width, height, DefaultDepth(display, screen));
+        gc = XCreateGC(display, pixmap, 0, NULL);
+        XSetForeground(display, gc, BlackPixel(display, screen));
+    }
+
+    void clear() {
+        XSetForeground(display, gc, background);
+        XFillRectangle(display, pixmap, gc, 0, 0, width, height);
+        XSetForeground(display, gc, BlackPixel(display, DefaultScreen(display)));
+    }
 
-// --- WEEK 3: Generalized Bresenham's Line Algorithm ---
-// This version is the most efficient.
-// It works for all 8 octants (any slope) using only integer math.
-void drawLineBresenham(Display* display, Window window, GC gc, int x1, int y1, int x2, int y2) {
-    // TRICK 1: Handle "steep" lines by pretending they are "shallow".
-    // A steep line is one where the change in Y is greater than the change in X.
-    const bool is_steep = abs(y2 - y1) > abs(x2 - x1);
-    if (is_steep) {
-        // If it's steep, we swap the x and y coordinates. This reflects the line
-        // across the y=x axis, turning it into a shallow line.
-        std::swap(x1, y1);
-        std::swap(x2, y2);
-    }
-
-    // TRICK 2: Always draw from left-to-right.
-    // This simplifies our loop so we can always do `x++`.
-    if (x1 > x2) {
-        // If the starting point is to the right of the end point, swap them.
-        std::swap(x1, x2);
-        std::swap(y1, y2);
-    }
-
-    // Now, we can do the core Bresenham calculation.
-    const int dx = x2 - x1;
-    const int dy = abs(y2 - y1);
-    
-    // We need to know if y should be incrementing or decrementing.
-    const int y_step = (y1 < y2) ? 1 : -1;
-
-    // This is the "error term" or "decision parameter". It keeps track of
-    // how far our pixel line has drifted from the true mathematical line.
-    int error = dx / 2;
-    int y = y1;
-
-    // Loop through every x from the start to the end.
-    for (int x = x1; x <= x2; x++) {
-        // Draw the pixel.
-        // IMPORTANT: If we swapped coordinates earlier (for a steep line),
-        // we must "un-swap" them here, right before drawing.
-        if (is_steep) {
-            XDrawPoint(display, window, gc, y, x);
+    // Brings the pixmap up to date through either X target.
+    template <typename Target>
+    void update(Target& target, const vector<Line>& user_lines, const vector<Circle>& user_circles,
+                const vector<Ellipse>& user_ellipses, const vector<Polygon>& user_polygons, DrawAlgorithm algo) {
+        if (state.needsRebuild(algo)) {
+            clear();
+            drawUserShapes(target, user_lines, user_circles, user_ellipses, user_polygons, algo);
+            state.rebuilt(algo, user_lines.size(), user_circles.size(), user_ellipses.size(), user_polygons.size());
         } else {
-            XDrawPoint(display, window, gc, x, y);
+            drawNewUserShapes(target, state, user_lines, user_circles, user_ellipses, user_polygons);
         }
+    }
 
-        // Update the error term. Each step in x adds to the error.
-        error -= dy;
+    // Copies one rectangle of the layer to the same place in the window.
+    void copyTo(Drawable drawable, GC target_gc, const ClipRect& r) {
+        XCopyArea(display, pixmap, drawable, target_gc, r.xmin, r.ymin,
+                  r.xmax - r.xmin + 1, r.ymax - r.ymin + 1, r.xmin, r.ymin);
+    }
 
-        // Check if the error has crossed the threshold.
-        if (error < 0) {
-            // If it has, it's time to step in the y direction to correct it.
-            y += y_step;
-            // And we reset the error by adding dx back.
-            error += dx;
+    void destroy() {
+        if (pixmap) {
+            XFreeGC(display, gc);
+            XFreePixmap(display, pixmap);
+            pixmap = 0;
         }
     }
-}
+};
 
+// --- Back Buffer ---
+// Each frame is drawn into drawable() and shown all at once by present().
+// Both back buffers keep their contents from one frame to the next (DBE
+// with the "copied" swap action), which the dirty rectangles rely on: only
+// the damaged parts of the back buffer are redrawn.
+struct BackBuffer {
+    Display* display = nullptr;
+    Window window = 0;
+    PresentMode mode = PresentMode::DIRECT;
+    XdbeBackBuffer dbe_buffer = 0;
+    Pixmap pixmap = 0;
 
-// --- WEEK 4: 8-Way Symmetry Pixel Plotter ---
-// This is a helper function for our circle algorithm.
-// It takes one point (x, y) relative to the center (cx, cy)
-// and draws all 8 symmetrical points of the circle.
-void drawCirclePixels(Display* display, Window window, GC gc, int cx, int cy, int x, int y) {
-    XDrawPoint(display, window, gc, cx + x, cy + y);
-    XDrawPoint(display, window, gc, cx - x, cy + y);
-    XDrawPoint(display, window, gc, cx + x, cy - y);
-    XDrawPoint(display, window, gc, cx - x, cy - y);
-    XDrawPoint(display, window, gc, cx + y, cy + x);
-    XDrawPoint(display, window, gc, cx - y, cy + x);
-    XDrawPoint(display, window, gc, cx + y, cy - x);
-    XDrawPoint(display, window, gc, cx - y, cy - x);
-}
+    // Tries the requested mode first, then DBE, then a Pixmap, then direct.
+    void init(Display* dpy, Window win, int screen, int width, int height, PresentMode requested) {
+        display = dpy;
+        window = win;
+        if (requested == PresentMode::DBE && initDbe(screen)) {
+            mode = PresentMode::DBE;
+        } else if (requested != PresentMode::DIRECT) {
+            pixmap = XCreatePixmap(display, window, width, height, DefaultDepth(display, screen));
+            mode = PresentMode::PIXMAP;
+        }
+    }
 
-// --- WEEK 4: Midpoint Circle Algorithm (Bresenham's) ---
-// This function calculates the points for one octant (45 degrees)
-// and uses the drawCirclePixels helper to draw all 8 octants.
-void drawCircleMidpoint(Display* display, Window window, GC gc, int centerX, int centerY, int radius) {
-    int x = 0;
-    int y = radius;
-
-    // This is the initial "decision parameter" or "error term".
-    // It's derived from the circle equation for the first midpoint.
-    int P = 1 - radius;
-
-    // Call the helper to draw the first set of points
-    // (e.g., (0, r), (0, -r), (r, 0), (-r, 0))
-    drawCirclePixels(display, window, gc, centerX, centerY, x, y);
-
-    // Loop until we've completed the first 45-degree octant
-    // (which is when x becomes greater than y)
-    while (x < y) {
-        x++; // Always step one pixel to the right
-
-        // --- This is the integer-only midpoint test ---
-        if (P < 0) {
-            // Midpoint is inside the circle.
-            // Choose the "East" (E) pixel: (x+1, y)
-            // Update the decision parameter for the next step.
-            P = P + (2 * x) + 1;
-        } else {
-            // Midpoint is outside or on the circle.
-            // Choose the "South-East" (SE) pixel: (x+1, y-1)
-            y--; // Move one pixel down
-            // Update the decision parameter for the next step.
-            P = P + (2 * x) + 1 - (2 * y);
+    bool initDbe(int screen) {
+        int major, minor;
+        if (!XdbeQueryExtension(display, &major, &minor)) {
+            cerr << "DBE extension not available, falling back to a Pixmap back buffer" << endl;
+            return false;
+        }
+        // Not every visual can be double buffered; the window uses the default one.
+        Drawable root = RootWindow(display, screen);
+        int screen_count = 1;
+        XdbeScreenVisualInfo* info = XdbeGetVisualInfo(display, &root, &screen_count);
+        bool supported = false;
+        VisualID visual = XVisualIDFromVisual(DefaultVisual(display, screen));
+        for (int i = 0; info && i < info->count; i++) {
+            supported = supported || info->visinfo[i].visual == visual;
+        }
+        if (info) {
+            XdbeFreeVisualInfo(info);
         }
+        if (!supported) {
+            cerr << "DBE cannot double buffer the default visual, falling back to a Pixmap back buffer" << endl;
+            return false;
+        }
+        dbe_buffer = XdbeAllocateBackBufferName(display, window, XdbeCopied);
+        return dbe_buffer != 0;
+    }
+
+    Drawable drawable() const {
+        if (mode == PresentMode::DBE) {
+            return dbe_buffer;
+        }
+        return mode == PresentMode::PIXMAP ? pixmap : window;
+    }
 
-        // We have our new (x, y) for this octant.
-        // Call the helper to draw all 8 symmetric points.
-        drawCirclePixels(display, window, gc, centerX, centerY, x, y);
+    const char* name() const {
+        if (mode == PresentMode::DBE) {
+            return "DBE swap";
+        }
+        return mode == PresentMode::PIXMAP ? "Pixmap copy" : "Direct (no back buffer)";
+    }
+
+    // DBE swaps the whole window; the Pixmap path only copies what changed.
+    void present(GC gc, const vector<ClipRect>& rects) {
+        if (mode == PresentMode::DBE) {
+            XdbeSwapInfo swap_info = {window, XdbeCopied};
+            XdbeSwapBuffers(display, &swap_info, 1);
+        } else if (mode == PresentMode::PIXMAP) {
+            for (const ClipRect& r : rects) {
+                XCopyArea(display, pixmap, window, gc, r.xmin, r.ymin,
+                          r.xmax - r.xmin + 1, r.ymax - r.ymin + 1, r.xmin, r.ymin);
+            }
+        }
     }
+
+    void destroy() {
+        if (mode == PresentMode::DBE) {
+            XdbeDeallocateBackBufferName(display, dbe_buffer);
+        } else if (mode == PresentMode::PIXMAP) {
+            XFreePixmap(display, pixmap);
+        }
+        mode = PresentMode::DIRECT;
+    }
+};
+
+// --- Framebuffer Presenter ---
+// Owns the XImage behind our Framebuffer and uploads it to the window.
+// With MIT-SHM the pixels live in a shared memory segment and XShmPutImage
+// lets the server read them directly; otherwise a plain XPutImage copies
+// the whole buffer through the socket, which is still a single request.
+static bool shm_attach_failed = false;
+
+static int shmAttachErrorHandler(Display*, XErrorEvent*) {
+    // XShmAttach fails with BadAccess when the server is on another machine.
+    shm_attach_failed = true;
+    return 0;
 }
 
+struct FramebufferPresenter {
+    Display* display = nullptr;
+    XImage* image = nullptr;
+    XShmSegmentInfo shm_info = {};
+    bool use_shm = false;
+    vector<uint32_t> storage; // Only used without MIT-SHM
+    Framebuffer fb;
+
+    bool init(Display* dpy, int screen, int width, int height) {
+        display = dpy;
+        Visual* visual = DefaultVisual(display, screen);
+        int depth = DefaultDepth(display, screen);
+
+        // We write 32-bit pixels directly, so we need a 24/32-bit TrueColor visual.
+        if ((depth != 24 && depth != 32) || visual->c_class != TrueColor) {
+            cerr << "Framebuffer backend needs a 24/32-bit TrueColor visual" << endl;
+            return false;
+        }
 
-// General 3D wireframe drawing (uses our brute-force function)
-void drawEdges(Display* display, Window window, GC gc,
-               const vector<Point3D>& vertices,
-               const vector<pair<int, int>>& edges,
-               float angle, int posX, int posY, DrawAlgorithm algo) {
-    for (const auto& edge : edges) {
-        Point3D p1 = vertices[edge.first];
-        Point3D p2 = vertices[edge.second];
+        if (XShmQueryExtension(display)) {
+            image = XShmCreateImage(display, visual, depth, ZPixmap, NULL, &shm_info, width, height);
+            if (image) {
+                shm_info.shmid = shmget(IPC_PRIVATE, image->bytes_per_line * image->height, IPC_CREAT | 0600);
+                void* address = shm_info.shmid >= 0 ? shmat(shm_info.shmid, NULL, 0) : (void*)-1;
+                if (address == (void*)-1) {
+                    // No segment, or we could not map it (e.g. over the SHM limits)
+                    if (shm_info.shmid >= 0) {
+                        shmctl(shm_info.shmid, IPC_RMID, NULL);
+                    }
+                } else {
+                    shm_info.shmaddr = image->data = (char*)address;
+                    shm_info.readOnly = False;
 
-        // simple rotation (XZ plane)
-        float p1_rot_x = p1.x * cos(angle) - p1.z * sin(angle);
-        float p1_rot_y = p1.y;
-        float p2_rot_x = p2.x * cos(angle) - p2.z * sin(angle);
-        float p2_rot_y = p2.y;
+                    shm_attach_failed = false;
+                    XErrorHandler old_handler = XSetErrorHandler(shmAttachErrorHandler);
+                    XShmAttach(display, &shm_info);
+                    XSync(display, False);
+                    XSetErrorHandler(old_handler);
 
-        int p1_screen_x = static_cast<int>(p1_rot_x + posX);
-        int p1_screen_y = static_cast<int>(p1_rot_y + posY);
-        int p2_screen_x = static_cast<int>(p2_rot_x + posX);
-        int p2_screen_y = static_cast<int>(p2_rot_y + posY);
+                    // Mark the segment for deletion now; it goes away once both
+                    // we and the server have detached from it.
+                    shmctl(shm_info.shmid, IPC_RMID, NULL);
+                    use_shm = !shm_attach_failed;
+                    if (!use_shm) {
+                        shmdt(shm_info.shmaddr);
+                    }
+                }
+                if (!use_shm) {
+                    image->data = NULL;
+                    XDestroyImage(image);
+                    image = nullptr;
+                }
+            }
+        }
 
-        if (algo == DrawAlgorithm::BRESENHAM) {
-            drawLineBresenham(display, window, gc, p1_screen_x, p1_screen_y, p2_screen_x, p2_screen_y);
-        } else if (algo == DrawAlgorithm::DDA) {
-            drawLineDDA(display, window, gc, p1_screen_x, p1_screen_y, p2_screen_x, p2_screen_y);
-        } else { // Default to Brute-Force
-            drawLineBruteForce(display, window, gc, p1_screen_x, p1_screen_y, p2_screen_x, p2_screen_y);
+        if (!use_shm) {
+            storage.assign(width * height, 0);
+            image = XCreateImage(display, visual, depth, ZPixmap, 0, (char*)storage.data(),
+                                 width, height, 32, width * 4);
+            if (!image) {
+                cerr << "XCreateImage failed" << endl;
+                return false;
+            }
+            // We write native 32-bit words, Xlib swaps for the server if needed.
+            image->byte_order = LSBFirst;
         }
+
+        fb.pixels = (uint32_t*)image->data;
+        fb.width = width;
+        fb.height = height;
+        fb.stride = image->bytes_per_line / 4;
+        fb.clip = {0, 0, width - 1, height - 1};
+        return true;
+    }
+
+    void present(Drawable drawable, GC gc) {
+        present(drawable, gc, {0, 0, fb.width - 1, fb.height - 1});
+    }
+
+    // Uploads only one rectangle of the framebuffer to the same place in the window.
+    void present(Drawable drawable, GC gc, const ClipRect& r) {
+        int w = r.xmax - r.xmin + 1, h = r.ymax - r.ymin + 1;
+        if (use_shm) {
+            XShmPutImage(display, drawable, gc, image, r.xmin, r.ymin, r.xmin, r.ymin, w, h, False);
+        } else {
+            XPutImage(display, drawable, gc, image, r.xmin, r.ymin, r.xmin, r.ymin, w, h);
+        }
+    }
+
+    void destroy() {
+        if (!image) {
+            return;
+        }
+        if (use_shm) {
+            XShmDetach(display, &shm_info);
+            XSync(display, False);
+            shmdt(shm_info.shmaddr);
+        }
+        image->data = NULL; // The pixel memory is not owned by the XImage
+        XDestroyImage(image);
+        image = nullptr;
+    }
+};
+
+int main(int argc, char** argv) {
+    PresentMode requested_present = PresentMode::DBE;
+    double target_fps = 60.0; // 0 = uncapped
+    string obj_path;
+    size_t instance_count = 0; // Stress mode cubes, N cycles through INSTANCE_STEPS
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--check") {
+            return runChecks();
+        } else if (arg == "--present" && i + 1 < argc) {
+            string mode = argv[++i];
+            if (mode == "dbe") {
+                requested_present = PresentMode::DBE;
+            } else if (mode == "pixmap") {
+                requested_present = PresentMode::PIXMAP;
+            } else if (mode == "direct") {
+                requested_present = PresentMode::DIRECT;
+            } else {
+                cerr << "Unknown --present mode '" << mode << "' (dbe, pixmap or direct)" << endl;
+                return 1;
+            }
+        } else if (arg == "--fps" && i + 1 < argc) {
+            target_fps = atof(argv[++i]);
+            if (target_fps <= 0) {
+                cerr << "--fps needs a positive frame rate (use --uncapped to run flat out)" << endl;
+                return 1;
+            }
+        } else if (arg == "--uncapped") {
+            target_fps = 0;
+        } else if (arg == "--obj" && i + 1 < argc) {
+            obj_path = argv[++i];
+        } else if (arg == "--instances" && i + 1 < argc) {
+            instance_count = min<size_t>(strtoul(argv[++i], NULL, 10), MAX_INSTANCES);
+        } else {
+            cerr << "Usage: " << argv[0]
+                 << " [--check] [--present dbe|pixmap|direct] [--fps N | --uncapped] [--obj mesh.obj]"
+                    " [--instances N]" << endl;
+            return 1;
+        }
+    }
+
+    // --- Mesh Loading ---
+    // An .obj mesh replaces the spine, scaled to about the spine's size
+    ObjMesh obj_mesh;
+    if (!obj_path.empty()) {
+        string error;
+        if (!loadObj(obj_path, obj_mesh, error)) {
+            cerr << "Cannot load mesh: " << error << endl;
+            return 1;
+        }
+        printf("Loaded %s: %zu vertices, %zu faces, %zu edges; parsed %.1f MB in %.1f ms (%.0f MB/s)\n",
+               obj_path.c_str(), obj_mesh.vertices.x.size(), obj_mesh.faces, obj_mesh.edges.size(),
+               obj_mesh.bytes / 1e6, obj_mesh.parse_seconds * 1000.0, obj_mesh.megabytesPerSecond());
+        fitObjMesh(obj_mesh, OBJ_MODEL_SIZE);
     }
-}
 
-int main() {
     // --- X11 Setup ---
     Display* display = XOpenDisplay(NULL);
     if (!display) {
@@ -314,20 +518,104 @@ int main() {
     XSelectInput(display, window, ExposureMask | StructureNotifyMask | ButtonPressMask | KeyPressMask);
     GC gc = XCreateGC(display, window, 0, NULL);
     XSetForeground(display, gc, BlackPixel(display, screen));
+    // XCopyArea from the static layer would otherwise queue a NoExpose event per copy
+    XSetGraphicsExposures(display, gc, False);
     XMapWindow(display, window);
 
+    // --- Back Buffer Setup ---
+    BackBuffer back_buffer;
+    back_buffer.init(display, window, screen, WINDOW_WIDTH, WINDOW_HEIGHT, requested_present);
+    cout << "Presenting with: " << back_buffer.name() << endl;
+    const Drawable frame_target = back_buffer.drawable(); // Where every frame is drawn
+
+    // --- Framebuffer Backend Setup ---
+    FramebufferPresenter presenter;
+    bool framebuffer_available = presenter.init(display, screen, WINDOW_WIDTH, WINDOW_HEIGHT);
+    if (framebuffer_available) {
+        presenter.fb.color = BlackPixel(display, screen);
+        cout << "Framebuffer backend ready (" << (presenter.use_shm ? "MIT-SHM" : "XPutImage") << ")" << endl;
+    }
+
+    // --- Static Layers ---
+    // The user's shapes, rasterized once (see StaticLayer.h)
+    FramebufferLayer framebuffer_layer;
+    if (framebuffer_available) {
+        framebuffer_layer.init(WINDOW_WIDTH, WINDOW_HEIGHT, BlackPixel(display, screen), WhitePixel(display, screen));
+    }
+    PixmapLayer pixmap_layer;
+    pixmap_layer.init(display, window, screen, WINDOW_WIDTH, WINDOW_HEIGHT);
+
     // --- Variables ---
     DrawAlgorithm current_algo = DrawAlgorithm::BRUTE_FORCE;
+    RenderBackend current_backend = RenderBackend::XLIB_POINTS;
+    XPointBatchTarget point_batch;
+    point_batch.init(display, WINDOW_WIDTH, WINDOW_HEIGHT);
+    TileRenderer tile_renderer;
+    tile_renderer.init(WINDOW_WIDTH, WINDOW_HEIGHT, max(1u, thread::hardware_concurrency()));
+    bool tiled_rendering = false; // Rebuild the framebuffer layer on all threads
     DrawMode current_draw_mode = DrawMode::LINE;
+    CircleStyle circle_style = CircleStyle::OUTLINE; // For new circles, O cycles it
     vector<Line> user_lines;
     vector<Circle> user_circles;
+    bool ellipse_filled = false; // For new ellipses, O toggles it in ELLIPSE mode
+    int ellipse_angle = 0;       // For new ellipses, A turns it by 15 degrees
+    vector<Ellipse> user_ellipses;
+    FillRule polygon_rule = FillRule::EVEN_ODD; // For new polygons, Z toggles it
+    Polygon open_polygon;                       // The polygon being clicked in, closed with Enter
+    vector<Polygon> user_polygons;
+    bool solid_cube = false; // V draws the cube with filled faces
+    bool hidden_lines = false; // H removes the hidden parts of the wireframes
+    DepthBuffer depth_buffer;
+    depth_buffer.resize(WINDOW_WIDTH, WINDOW_HEIGHT);
     bool has_start_point = false;
     int start_x = 0, start_y = 0;
-    float angle = 0.0f;
-    int cube_x = 200, cube_y = 200, cube_dx = 1, cube_dy = 1;
-    int spine_x = 400, spine_y = 300;
+    SceneSimulation simulation; // Steps at a fixed rate, independent of the frame rate
+    SceneMeshes meshes;
+    meshes.model = move(obj_mesh.vertices);
+    meshes.model_edges = move(obj_mesh.edges);
+    meshes.model_triangles = move(obj_mesh.triangles);
+    meshes.spawnInstances(instance_count, 1);
+    bool collisions = false; // K makes the instances bounce off each other
+    InstanceCollisions collider;
     bool running = true;
 
+    // --- Damage Tracking ---
+    // Only the rectangles in "damage" are cleared and repainted each frame;
+    // the rest of the window keeps what it already shows.
+    DamageList damage;
+    damage.init(WINDOW_WIDTH, WINDOW_HEIGHT);
+    damage.addAll();
+    bool dirty_rects = true; // U toggles back to a full repaint every frame
+    ClipRect last_cube_bounds = {0, 0, -1, -1}, last_spine_bounds = {0, 0, -1, -1};
+    DrawAlgorithm drawn_algo = current_algo;
+    RenderBackend drawn_backend = current_backend;
+    // The overlay text is drawn over the finished frame, so when it changes
+    // its band has to be repainted to wipe the old text.
+    const ClipRect hud_rect = {0, 0, WINDOW_WIDTH - 1, 148};
+    string last_hud_text;
+
+    // --- Frame Timing ---
+    // Frames start on the scheduler's deadlines (--fps, 60 by default), or
+    // back to back with --uncapped. Work time only covers making the frame,
+    // not waiting for the next deadline, so the backends can be compared
+    // at any frame rate. It waits
+    // for the server to finish drawing, and the swap (or copy) that shows
+    // the frame is timed on its own, so the present modes can be compared.
+    using Clock = chrono::steady_clock;
+    Clock::time_point stats_start = Clock::now();
+    int stats_frames = 0;
+    double stats_work_ms = 0.0, stats_swap_ms = 0.0;
+    double shown_fps = 0.0, shown_work_ms = 0.0, shown_swap_ms = 0.0;
+    // Xlib numbers every request it sends, so the difference in sequence
+    // numbers over a frame is exactly how many X requests the frame issued.
+    unsigned long frame_requests = 0, shown_requests = 0;
+    long long stats_repainted = 0; // Pixels repainted since the last update
+    double shown_repainted = 0.0;  // ... as a percentage of the window
+    FrameScheduler scheduler;
+    scheduler.init(target_fps);
+    Clock::time_point last_frame_start = Clock::now();
+    ScheduleStats shown_schedule;
+
     // --- Main Loop ---
     while (running) {
         // Handle input
@@ -346,15 +634,116 @@ int main() {
                 } else if (keysym == XK_d || keysym == XK_D) {
                     current_algo = DrawAlgorithm::DDA;
                     cout << "Switched to DDA Algorithm" << endl;
+                } else if (keysym == XK_i || keysym == XK_I) {
+                    current_algo = DrawAlgorithm::DDA_FIXED;
+                    cout << "Switched to Fixed-Point DDA Algorithm" << endl;
                 } else if (keysym == XK_b || keysym == XK_B) {
                     current_algo = DrawAlgorithm::BRESENHAM;
                     cout << "Switched to Bresenham's Algorithm" << endl;
+                } else if (keysym == XK_s || keysym == XK_S) {
+                    current_algo = DrawAlgorithm::RUN_SLICE;
+                    cout << "Switched to Run-Slice Bresenham Algorithm" << endl;
+                } else if (keysym == XK_w || keysym == XK_W) {
+                    current_algo = DrawAlgorithm::WU;
+                    cout << "Switched to Wu's Anti-Aliased Algorithm"
+                         << (current_backend == RenderBackend::FRAMEBUFFER ? "" : " (only blended on the framebuffer backend)")
+                         << endl;
                 }else if (keysym == XK_l || keysym == XK_L) {
                     current_draw_mode = DrawMode::LINE;
                     cout << "Switched to LINE drawing mode" << endl;
                 } else if (keysym == XK_c || keysym == XK_C) {
                     current_draw_mode = DrawMode::CIRCLE;
                     cout << "Switched to CIRCLE drawing mode" << endl;
+                } else if (keysym == XK_e || keysym == XK_E) {
+                    current_draw_mode = DrawMode::ELLIPSE;
+                    cout << "Switched to ELLIPSE drawing mode" << endl;
+                } else if (keysym == XK_a || keysym == XK_A) {
+                    ellipse_angle = (ellipse_angle + 15) % 180;
+                    cout << "New ellipses are turned by " << ellipse_angle << " degrees" << endl;
+                } else if ((keysym == XK_o || keysym == XK_O) && current_draw_mode == DrawMode::ELLIPSE) {
+                    ellipse_filled = !ellipse_filled;
+                    cout << (ellipse_filled ? "New ellipses are filled" : "New ellipses are outlines") << endl;
+                } else if (keysym == XK_o || keysym == XK_O) {
+                    if (circle_style == CircleStyle::OUTLINE) {
+                        circle_style = CircleStyle::FILLED;
+                        cout << "New circles are filled discs" << endl;
+                    } else if (circle_style == CircleStyle::FILLED) {
+                        circle_style = CircleStyle::RING;
+                        cout << "New circles are thick rings" << endl;
+                    } else {
+                        circle_style = CircleStyle::OUTLINE;
+                        cout << "New circles are outlines" << endl;
+                    }
+                } else if (keysym == XK_p || keysym == XK_P) {
+                    if (current_backend == RenderBackend::XLIB_POINTS) {
+                        current_backend = RenderBackend::XLIB_BATCHED;
+                        cout << "Switched to batched XDrawPoints backend" << endl;
+                    } else if (current_backend == RenderBackend::XLIB_BATCHED && framebuffer_available) {
+                        current_backend = RenderBackend::FRAMEBUFFER;
+                        cout << "Switched to Framebuffer backend" << endl;
+                    } else {
+                        current_backend = RenderBackend::XLIB_POINTS;
+                        cout << "Switched to XDrawPoint backend" << endl;
+                    }
+                } else if (keysym == XK_t || keysym == XK_T) {
+                    tiled_rendering = !tiled_rendering;
+                    cout << "Tiled layer rebuilds " << (tiled_rendering ? "ON" : "OFF")
+                         << " (" << tile_renderer.threadCount() << " threads, framebuffer backend only)" << endl;
+                } else if (keysym == XK_r || keysym == XK_R) {
+                    // Scatter a batch of random lines to load the renderer
+                    for (int i = 0; i < 1000; i++) {
+                        user_lines.push_back({rand() % WINDOW_WIDTH, rand() % WINDOW_HEIGHT,
+                                              rand() % WINDOW_WIDTH, rand() % WINDOW_HEIGHT});
+                    }
+                    for (size_t i = user_lines.size() - 1000; i < user_lines.size(); i++) {
+                        damage.add(lineBounds(user_lines[i]));
+                    }
+                    cout << "Added 1000 random lines (" << user_lines.size() << " total)" << endl;
+                } else if (keysym == XK_u || keysym == XK_U) {
+                    dirty_rects = !dirty_rects;
+                    cout << (dirty_rects ? "Repainting dirty rectangles only" : "Repainting the whole window") << endl;
+                } else if (keysym == XK_g || keysym == XK_G) {
+                    current_draw_mode = DrawMode::POLYGON;
+                    cout << "Switched to POLYGON drawing mode (click the corners, Enter closes it)" << endl;
+                } else if (keysym == XK_z || keysym == XK_Z) {
+                    polygon_rule = (polygon_rule == FillRule::EVEN_ODD) ? FillRule::NON_ZERO : FillRule::EVEN_ODD;
+                    cout << "New polygons are filled " << (polygon_rule == FillRule::EVEN_ODD ? "even-odd" : "non-zero")
+                         << endl;
+                } else if (keysym == XK_Return || keysym == XK_KP_Enter) {
+                    if (open_polygon.x.size() >= 3) {
+                        open_polygon.rule = polygon_rule;
+                        buildEdgeTable(open_polygon);
+                        user_polygons.push_back(move(open_polygon));
+                        damage.add(user_polygons.back().bounds);
+                        cout << "Polygon closed with " << user_polygons.back().x.size() << " corners" << endl;
+                    } else {
+                        cout << "A polygon needs at least 3 corners" << endl;
+                    }
+                    open_polygon = Polygon();
+                } else if (keysym == XK_v || keysym == XK_V) {
+                    solid_cube = !solid_cube;
+                    cout << (solid_cube ? "Cube drawn with filled faces" : "Cube drawn as a wireframe") << endl;
+                } else if (keysym == XK_h || keysym == XK_H) {
+                    hidden_lines = !hidden_lines;
+                    cout << (hidden_lines ? "Hidden lines removed (depth buffer, Bresenham)" : "All lines drawn") << endl;
+                } else if (keysym == XK_n || keysym == XK_N) {
+                    // Stress mode: 0, 100, 1000, 10000, 100000 cubes and around again
+                    instance_count = instance_count == 0 ? 100 : instance_count * 10;
+                    if (instance_count > MAX_INSTANCES) {
+                        instance_count = 0;
+                    }
+                    meshes.spawnInstances(instance_count, rand());
+                    damage.addAll();
+                    cout << "Stress mode: " << instance_count << " instanced cubes" << endl;
+                } else if (keysym == XK_k || keysym == XK_K) {
+                    collisions = !collisions;
+                    collider.stats = CollisionStats();
+                    cout << (collisions ? "Instance collisions ON" : "Instance collisions OFF") << endl;
+                } else if (keysym == XK_bracketleft || keysym == XK_bracketright) {
+                    // Tune the spatial hash: halve or double its cells
+                    float& cell = collider.grid.cell_size;
+                    cell = keysym == XK_bracketleft ? max(5.0f, cell / 2) : min(640.0f, cell * 2);
+                    cout << "Collision cells: " << cell << " px" << endl;
                 }
             }
 
@@ -373,6 +762,7 @@ int main() {
                         int end_y = event.xbutton.y;
                         cout << "Line end set to: (" << end_x << ", " << end_y << ")" << endl;
                         user_lines.push_back({start_x, start_y, end_x, end_y});
+                        damage.add(lineBounds(user_lines.back()));
                         has_start_point = false; // Reset for the next line
                     }
                 } 
@@ -397,10 +787,43 @@ int main() {
                         cout << "New circle radius: " << radius << endl;
 
                         // Save the new circle
-                        user_circles.push_back({start_x, start_y, radius});
+                        // Rings keep the outer quarter of the radius
+                        user_circles.push_back({start_x, start_y, radius, circle_style, radius * 3 / 4});
+                        damage.add(circleBounds(user_circles.back()));
                         has_start_point = false; // Reset for the next circle
                     }
                 }
+                // --- LOGIC FOR ELLIPSE DRAWING ---
+                else if (current_draw_mode == DrawMode::ELLIPSE) {
+                    if (!has_start_point) {
+                        // First click: Set the ellipse's center point
+                        start_x = event.xbutton.x;
+                        start_y = event.xbutton.y;
+                        cout << "Ellipse center set to: (" << start_x << ", " << start_y << ")" << endl;
+                        has_start_point = true;
+                    } else {
+                        // Second click: a corner of the (unrotated) bounding box
+                        int rx = abs(event.xbutton.x - start_x);
+                        int ry = abs(event.xbutton.y - start_y);
+                        cout << "New ellipse half-axes: " << rx << " x " << ry << ", turned by " << ellipse_angle
+                             << " degrees" << endl;
+                        user_ellipses.push_back({start_x, start_y, rx, ry, ellipse_angle, ellipse_filled});
+                        damage.add(ellipseBounds(user_ellipses.back()));
+                        has_start_point = false; // Reset for the next ellipse
+                    }
+                }
+                // --- LOGIC FOR POLYGON DRAWING ---
+                else if (current_draw_mode == DrawMode::POLYGON) {
+                    // Every click adds a corner; Enter joins the last one back to the first
+                    open_polygon.x.push_back(event.xbutton.x);
+                    open_polygon.y.push_back(event.xbutton.y);
+                    cout << "Polygon corner " << open_polygon.x.size() << " at: (" << event.xbutton.x << ", "
+                         << event.xbutton.y << ")" << endl;
+                }
+            }
+            if (event.type == Expose) {
+                damage.add({event.xexpose.x, event.xexpose.y, event.xexpose.x + event.xexpose.width - 1,
+                            event.xexpose.y + event.xexpose.height - 1});
             }
             if (event.type == ClientMessage &&
                 (Atom)event.xclient.data.l[0] == delWindow) {
@@ -408,62 +831,242 @@ int main() {
             }
         }
 
-        // Clear window
-        XClearWindow(display, window);
+        // Sleep until the next frame is due, but wake up for input
+        if (!scheduler.wait(ConnectionNumber(display))) {
+            continue;
+        }
+        scheduler.beginFrame();
+
+        Clock::time_point work_start = Clock::now();
+        unsigned long frame_first_request = NextRequest(display);
+
+        // Update cube position + rotation: run the simulation steps that are
+        // due, then draw the pose between the last two of them.
+        long long steps_before = simulation.steps;
+        simulation.advance(chrono::duration<double>(work_start - last_frame_start).count());
+        last_frame_start = work_start;
+        // The instances step along with the simulation (they are not interpolated)
+        for (long long step = steps_before; step < simulation.steps; step++) {
+            meshes.instances.step();
+            if (collisions) {
+                collider.resolve(meshes.instances);
+            }
+        }
+
+        meshes.transform(simulation.pose());
+
+        // --- Collect This Frame's Damage ---
+        // The moving objects damage both where they were and where they are now.
+        ClipRect cube_bounds = vertexBounds(meshes.cube_screen);
+        ClipRect spine_bounds = vertexBounds(meshes.spine_screen);
+        damage.add(last_cube_bounds);
+        damage.add(cube_bounds);
+        damage.add(last_spine_bounds);
+        damage.add(spine_bounds);
+        last_cube_bounds = cube_bounds;
+        last_spine_bounds = spine_bounds;
+        // A different algorithm or backend changes (or has not yet drawn) every
+        // pixel, and the stress mode's cubes move all over the window
+        if (!dirty_rects || current_algo != drawn_algo || current_backend != drawn_backend ||
+            meshes.instances.size() > 0) {
+            damage.addAll();
+            drawn_algo = current_algo;
+            drawn_backend = current_backend;
+        }
 
-        // --- Draw UI Text for current algorithm ---
+        // --- UI Text for the current state ---
         string algo_text = "Algorithm: ";
-        if (current_algo == DrawAlgorithm::BRESENHAM) {
+        if (current_algo == DrawAlgorithm::WU) {
+            algo_text += current_backend == RenderBackend::FRAMEBUFFER ? "Wu Anti-Aliased (W)"
+                                                                       : "Wu, thresholded without framebuffer (W)";
+        } else if (current_algo == DrawAlgorithm::RUN_SLICE) {
+            algo_text += "Run-Slice (S)";
+        } else if (current_algo == DrawAlgorithm::BRESENHAM) {
             algo_text += "Bresenham (B)";
         } else if (current_algo == DrawAlgorithm::DDA) {
             algo_text += "DDA (D)";
+        } else if (current_algo == DrawAlgorithm::DDA_FIXED) {
+            algo_text += "Fixed-Point DDA (I)";
         } else {
             algo_text += "Brute-Force (F)";
         }
-        XDrawString(display, window, gc, 10, 20, algo_text.c_str(), algo_text.length());
 
         string mode_text = "Mode: ";
         if (current_draw_mode == DrawMode::LINE) {
             mode_text += "Line (L)";
+        } else if (current_draw_mode == DrawMode::ELLIPSE) {
+            mode_text += "Ellipse (E)";
+            mode_text += ellipse_filled ? ", filled (O)" : ", outline (O)";
+            mode_text += ", turned " + to_string(ellipse_angle) + " degrees (A)";
+        } else if (current_draw_mode == DrawMode::POLYGON) {
+            mode_text += "Polygon (G), ";
+            mode_text += polygon_rule == FillRule::EVEN_ODD ? "even-odd (Z)" : "non-zero (Z)";
+            mode_text += ", " + to_string(open_polygon.x.size()) + " corners so far (Enter closes)";
         } else {
             mode_text += "Circle (C)";
+            if (circle_style == CircleStyle::FILLED) {
+                mode_text += ", filled (O)";
+            } else if (circle_style == CircleStyle::RING) {
+                mode_text += ", ring (O)";
+            } else {
+                mode_text += ", outline (O)";
+            }
+            CircleCacheStats cache_stats = circleOctantCache().stats();
+            char cache_text[96];
+            snprintf(cache_text, sizeof(cache_text), "  Octant cache: %.1f%% hits, %zu radii kept",
+                     cache_stats.hitRate(), cache_stats.cached_radii);
+            mode_text += cache_text;
         }
 
-        XDrawString(display, window, gc, 10, 40, mode_text.c_str(), mode_text.length());
-
-        // Draw user lines with our new function
-        for (const auto& line : user_lines) {
-            if (current_algo == DrawAlgorithm::BRESENHAM) {
-                drawLineBresenham(display, window, gc, line.x1, line.y1, line.x2, line.y2);
-            } else if (current_algo == DrawAlgorithm::DDA) {
-                drawLineDDA(display, window, gc, line.x1, line.y1, line.x2, line.y2);
-            } else {
-                drawLineBruteForce(display, window, gc, line.x1, line.y1, line.x2, line.y2);
+        string backend_text = "Backend: ";
+        if (current_backend == RenderBackend::FRAMEBUFFER) {
+            backend_text += presenter.use_shm ? "Framebuffer + MIT-SHM (P)" : "Framebuffer + XPutImage (P)";
+            if (tiled_rendering) {
+                backend_text += ", tiled rebuilds on " + to_string(tile_renderer.threadCount()) + " threads (T)";
             }
+        } else if (current_backend == RenderBackend::XLIB_BATCHED) {
+            backend_text += "Batched XDrawPoints (P)";
+        } else {
+            backend_text += "XDrawPoint (P)";
+        }
+        backend_text += dirty_rects ? ", dirty rects (U)" : ", full repaint (U)";
+
+        char stats_text[160];
+        snprintf(stats_text, sizeof(stats_text),
+                 "FPS: %.1f  Work: %.2f ms  Swap: %.2f ms  X requests: %lu  Lines: %zu  Repainted: %.1f%%",
+                 shown_fps, shown_work_ms, shown_swap_ms, shown_requests, user_lines.size(), shown_repainted);
+
+        string present_text = string("Present: ") + back_buffer.name() + " (--present)";
+        string instance_text = "Instances: " + to_string(meshes.instances.size()) + " (N)";
+        if (collisions) {
+            const CollisionStats& c = collider.stats;
+            char collision_text[128];
+            snprintf(collision_text, sizeof(collision_text),
+                     "  Collisions (K): broad %.2f ms, narrow %.2f ms, %zu contacts, %.0f px cells ([ ])",
+                     c.broad_ms, c.narrow_ms, c.contacts, collider.grid.cell_size);
+            instance_text += collision_text;
+        } else {
+            instance_text += ", collisions off (K)";
+        }
+
+        char schedule_text[160];
+        if (scheduler.uncapped()) {
+            snprintf(schedule_text, sizeof(schedule_text), "Schedule: uncapped (--fps)  Jitter: %.2f ms  Worst: %.2f ms",
+                     shown_schedule.jitter_ms, shown_schedule.worst_ms);
+        } else {
+            snprintf(schedule_text, sizeof(schedule_text),
+                     "Schedule: %.0f fps (--fps)  Missed: %d  Jitter: %.2f ms  Worst: %.2f ms",
+                     scheduler.targetFps(), shown_schedule.missed, shown_schedule.jitter_ms, shown_schedule.worst_ms);
         }
 
-        for (const auto& circle : user_circles) {
-            // We only have one circle algorithm (Midpoint/Bresenham's)
-            // so we can call it directly.
-            drawCircleMidpoint(display, window, gc, circle.cx, circle.cy, circle.radius);
+        string hud_text =
+            algo_text + mode_text + backend_text + stats_text + present_text + schedule_text + instance_text;
+        if (hud_text != last_hud_text) {
+            damage.add(hud_rect);
+            last_hud_text = hud_text;
+        }
+
+        // --- Repaint the Damaged Rectangles ---
+        // First bring the static layer up to date (only new shapes, unless
+        // the algorithm changed). Then each rectangle gets a copy of the layer
+        // and the moving objects drawn on top, clipped to the rectangle. The
+        // rectangles never overlap, so all the copies can go first and all
+        // the drawing after. For the same reason one depth buffer clear
+        // serves all of them.
+        DepthBuffer* depth = nullptr;
+        if (hidden_lines) {
+            depth_buffer.clear();
+            depth = &depth_buffer;
+        }
+        if (current_backend == RenderBackend::FRAMEBUFFER) {
+            // Compose in memory, then upload just the damaged rectangles
+            Framebuffer& fb = presenter.fb;
+            framebuffer_layer.update(user_lines, user_circles, user_ellipses, user_polygons, current_algo,
+                                     tiled_rendering ? &tile_renderer : nullptr);
+            for (const ClipRect& r : damage.rects) {
+                Framebuffer target = fb;
+                target.clip = r;
+                framebuffer_layer.copyTo(target, r);
+                drawMeshesInRect(target, r, meshes, current_algo, solid_cube, depth);
+            }
+            for (const ClipRect& r : damage.rects) {
+                presenter.present(frame_target, gc, r);
+            }
+        } else if (current_backend == RenderBackend::XLIB_BATCHED) {
+            point_batch.begin(pixmap_layer.pixmap, pixmap_layer.gc);
+            point_batch.clip = {0, 0, WINDOW_WIDTH - 1, WINDOW_HEIGHT - 1};
+            pixmap_layer.update(point_batch, user_lines, user_circles, user_ellipses, user_polygons, current_algo);
+            point_batch.flush();
+
+            for (const ClipRect& r : damage.rects) {
+                pixmap_layer.copyTo(frame_target, gc, r);
+            }
+            point_batch.begin(frame_target, gc);
+            for (const ClipRect& r : damage.rects) {
+                point_batch.clip = r;
+                drawMeshesInRect(point_batch, r, meshes, current_algo, solid_cube, depth);
+            }
+            point_batch.flush();
+        } else {
+            XPointTarget layer_target = {display, pixmap_layer.pixmap, pixmap_layer.gc,
+                                         {0, 0, WINDOW_WIDTH - 1, WINDOW_HEIGHT - 1}};
+            pixmap_layer.update(layer_target, user_lines, user_circles, user_ellipses, user_polygons, current_algo);
+
+            for (const ClipRect& r : damage.rects) {
+                pixmap_layer.copyTo(frame_target, gc, r);
+            }
+            for (const ClipRect& r : damage.rects) {
+                XPointTarget target = {display, frame_target, gc, r};
+                drawMeshesInRect(target, r, meshes, current_algo, solid_cube, depth);
+            }
         }
 
-        // Update cube position + rotation
-        angle += 0.015f;
-        cube_x += cube_dx;
-        cube_y += cube_dy;
-        if (cube_x <= 40 || cube_x >= 560) cube_dx *= -1;
-        if (cube_y <= 40 || cube_y >= 560) cube_dy *= -1;
+        // The text is redrawn every frame; drawing the same text over itself changes nothing.
+        XDrawString(display, frame_target, gc, 10, 20, algo_text.c_str(), algo_text.length());
+        XDrawString(display, frame_target, gc, 10, 40, mode_text.c_str(), mode_text.length());
+        XDrawString(display, frame_target, gc, 10, 60, backend_text.c_str(), backend_text.length());
+        XDrawString(display, frame_target, gc, 10, 80, stats_text, strlen(stats_text));
+        XDrawString(display, frame_target, gc, 10, 100, present_text.c_str(), present_text.length());
+        XDrawString(display, frame_target, gc, 10, 120, schedule_text, strlen(schedule_text));
+        XDrawString(display, frame_target, gc, 10, 140, instance_text.c_str(), instance_text.length());
+
+        // Wait until the server has drawn the frame, so the swap is timed on its own.
+        XSync(display, False);
+        Clock::time_point work_end = Clock::now();
 
-        // Draw cube and spine
-        drawEdges(display, window, gc, cube_vertices, cube_edges, angle, cube_x, cube_y, current_algo);
-        drawEdges(display, window, gc, rayquaza_spine_vertices, rayquaza_spine_edges, -angle * 0.5f, spine_x, spine_y, current_algo);
+        back_buffer.present(gc, damage.rects);
+        frame_requests = NextRequest(display) - frame_first_request;
+        XSync(display, False);
+        Clock::time_point swap_end = Clock::now();
 
-        XFlush(display);
-        usleep(16667); // ~60fps
+        stats_repainted += damage.area();
+        damage.clear();
+        scheduler.endFrame();
+
+        stats_work_ms += chrono::duration<double, milli>(work_end - work_start).count();
+        stats_swap_ms += chrono::duration<double, milli>(swap_end - work_end).count();
+        stats_frames++;
+        double elapsed = chrono::duration<double>(work_end - stats_start).count();
+        if (elapsed >= 1.0) {
+            shown_fps = stats_frames / elapsed;
+            shown_work_ms = stats_work_ms / stats_frames;
+            shown_swap_ms = stats_swap_ms / stats_frames;
+            shown_requests = frame_requests;
+            shown_repainted = 100.0 * stats_repainted / ((double)stats_frames * WINDOW_WIDTH * WINDOW_HEIGHT);
+            shown_schedule = scheduler.takeStats();
+            stats_repainted = 0;
+            stats_frames = 0;
+            stats_work_ms = 0.0;
+            stats_swap_ms = 0.0;
+            stats_start = work_end;
+        }
     }
 
     // Cleanup
+    tile_renderer.shutdown();
+    pixmap_layer.destroy();
+    presenter.destroy();
+    back_buffer.destroy();
     XFreeGC(display, gc);
     XDestroyWindow(display, window);
     XCloseDisplay(display);
@@ -0,0 +1,233 @@
+// --- Scanline Polygon Fill ---
+// The classic edge table / active edge table algorithm. A polygon is cut
+// into its (non-horizontal) edges once, and those are sorted by the
+// scanline they start on: the edge table. Filling then walks down the
+// scanlines keeping the edges that cross the current one in the active
+// edge table, sorted by where they cross. Between crossings the fill rule
+// decides which runs are inside, and each run is one hspan.
+//
+// Pixel centers sit on integer coordinates. An edge covers the scanlines
+// from its top end up to (not including) its bottom end, and a run covers
+// the pixels from its left crossing up to (not including) its right one.
+// So polygons that share an edge never draw a pixel twice or leave a gap,
+// and a vertex where two edges meet is only counted once.
+#ifndef POLYGONS_H
+#define POLYGONS_H
+
+#include <algorithm>
+#include <climits>
+#include <vector>
+#include "Clip.h"
+
+enum class FillRule {
+    EVEN_ODD, // Inside where a ray crosses the outline an odd number of times
+    NON_ZERO  // Inside where the outline winds around the point at all
+};
+
+// One edge, pointing down: it covers scanlines y_top <= y < y_bottom and
+// crosses scanline y at x = x_top + dx * (y - y_top) / dy.
+struct PolygonEdge {
+    int y_top, y_bottom;
+    int x_top, dx, dy;
+    int winding; // +1 if the outline runs down along it, -1 if up
+};
+
+struct Polygon {
+    std::vector<int> x, y; // The vertices; the last one joins back to the first
+    FillRule rule = FillRule::EVEN_ODD;
+    std::vector<PolygonEdge> edge_table; // Made by buildEdgeTable, sorted by y_top
+    ClipRect bounds = {0, 0, -1, -1};
+};
+
+// Builds the polygon's edge table and bounds, once after its vertices are
+// set. Filling then never has to sort or allocate per scanline.
+inline void buildEdgeTable(Polygon& p) {
+    p.edge_table.clear();
+    p.bounds = {INT_MAX, INT_MAX, INT_MIN, INT_MIN};
+    const size_t n = p.x.size();
+    for (size_t i = 0; i < n; i++) {
+        size_t j = (i + 1 == n) ? 0 : i + 1;
+        p.bounds = {std::min(p.bounds.xmin, p.x[i]), std::min(p.bounds.ymin, p.y[i]),
+                    std::max(p.bounds.xmax, p.x[i]), std::max(p.bounds.ymax, p.y[i])};
+        if (p.y[i] == p.y[j]) {
+            continue; // Horizontal edges never cross a scanline
+        }
+        bool down = p.y[i] < p.y[j];
+        int top = down ? i : j, bottom = down ? j : i;
+        p.edge_table.push_back({p.y[top], p.y[bottom], p.x[top], p.x[bottom] - p.x[top], p.y[bottom] - p.y[top],
+                                down ? 1 : -1});
+    }
+    std::sort(p.edge_table.begin(), p.edge_table.end(),
+              [](const PolygonEdge& a, const PolygonEdge& b) { return a.y_top < b.y_top; });
+}
+
+// --- Active Edges ---
+// Where an active edge crosses the scanline, kept exactly: the first pixel
+// at or right of the crossing is "x", and "error" is how far (in 1/dy of a
+// pixel) the crossing lies left of it. Moving down a scanline adds dx/dy,
+// split once into a whole step and a remainder, so each edge steps with a
+// few additions, like the integer line algorithms in Lines.h.
+struct ActiveEdge {
+    int x;
+    long long error;      // 0 <= error < dy
+    int x_step;           // floor(dx / dy)
+    long long error_step; // dx - x_step * dy
+    int dy;
+    int y_bottom;
+    int winding;
+};
+
+inline long long floorDivide(long long num, long long den) {
+    return num >= 0 ? num / den : -((-num + den - 1) / den);
+}
+
+// Starts an edge at scanline y (which may be below its top, when the
+// polygon is clipped).
+inline ActiveEdge activateEdge(const PolygonEdge& e, int y) {
+    ActiveEdge a;
+    long long num = (long long)e.dx * (y - e.y_top);
+    long long offset = -floorDivide(-num, e.dy); // ceil(num / dy)
+    a.x = e.x_top + static_cast<int>(offset);
+    a.error = offset * e.dy - num;
+    a.x_step = static_cast<int>(floorDivide(e.dx, e.dy));
+    a.error_step = e.dx - (long long)a.x_step * e.dy;
+    a.dy = e.dy;
+    a.y_bottom = e.y_bottom;
+    a.winding = e.winding;
+    return a;
+}
+
+inline void stepEdge(ActiveEdge& a) {
+    a.x += a.x_step;
+    a.error -= a.error_step;
+    if (a.error < 0) {
+        a.error += a.dy;
+        a.x++;
+    }
+}
+
+// Fills the polygon (its edge table must be built) inside the target's
+// clip rectangle. Only the scanlines inside the clip rectangle are walked,
+// so a tile or a dirty rectangle only pays for its own rows.
+template <typename Target>
+void fillPolygon(Target& target, const Polygon& p) {
+    const ClipRect rect = target.clipRect();
+    const int y_first = std::max(p.bounds.ymin, rect.ymin);
+    const int y_last = std::min(p.bounds.ymax, rect.ymax);
+    if (y_first > y_last || p.bounds.xmax < rect.xmin || p.bounds.xmin > rect.xmax) {
+        return;
+    }
+
+    // Reused between calls (tiles fill polygons on several threads), so
+    // once it has grown to the busiest scanline nothing is allocated.
+    thread_local std::vector<ActiveEdge> active;
+    active.clear();
+    const std::vector<PolygonEdge>& table = p.edge_table;
+    size_t next = 0;
+
+    for (int y = y_first; y <= y_last; y++) {
+        // Edges that end here leave the table
+        size_t kept = 0;
+        for (size_t i = 0; i < active.size(); i++) {
+            if (active[i].y_bottom > y) {
+                active[kept++] = active[i];
+            }
+        }
+        active.resize(kept);
+        // Edges that start here (or above, on the first clipped scanline) join it
+        for (; next < table.size() && table[next].y_top <= y; next++) {
+            if (table[next].y_bottom > y) {
+                active.push_back(activateEdge(table[next], y));
+            }
+        }
+
+        // The order barely changes from one scanline to the next, so an
+        // insertion sort is close to a single pass. Outlines that cross
+        // themselves all over can reshuffle it completely; past a few moves
+        // per edge a full sort is cheaper.
+        size_t moves = 0, move_budget = 4 * active.size() + 64;
+        for (size_t i = 1; i < active.size() && moves <= move_budget; i++) {
+            ActiveEdge a = active[i];
+            size_t j = i;
+            for (; j > 0 && active[j - 1].x > a.x; j--) {
+                active[j] = active[j - 1];
+            }
+            active[j] = a;
+            moves += i - j;
+        }
+        if (moves > move_budget) {
+            std::sort(active.begin(), active.end(), [](const ActiveEdge& a, const ActiveEdge& b) { return a.x < b.x; });
+        }
+
+        // Runs between crossings: [left x, right x) of each inside stretch
+        int winding = 0;
+        for (size_t i = 0; i + 1 < active.size(); i++) {
+            winding += (p.rule == FillRule::EVEN_ODD) ? 1 : active[i].winding;
+            bool inside = (p.rule == FillRule::EVEN_ODD) ? (winding & 1) : winding != 0;
+            if (inside) {
+                int x1 = std::max(active[i].x, rect.xmin);
+                int x2 = std::min(active[i + 1].x - 1, rect.xmax);
+                if (x1 <= x2) {
+                    target.hspan(x1, x2, y);
+                }
+            }
+        }
+
+        for (ActiveEdge& a : active) {
+            stepEdge(a);
+        }
+    }
+}
+
+// --- Ordered Dithering ---
+// The targets draw in one color, so shades of a fill are made with a 4x4
+// Bayer pattern: a pixel is drawn when the pattern's value there is below
+// the shade (0 = nothing, 16 = solid). The pattern is tied to screen
+// coordinates, so tiles and dirty rectangles line up.
+const int BAYER_4X4[4][4] = {
+    {0, 8, 2, 10},
+    {12, 4, 14, 6},
+    {3, 11, 1, 9},
+    {15, 7, 13, 5},
+};
+
+// Wraps a target and thins its spans out to a dithered shade.
+template <typename Target>
+struct DitheredTarget {
+    Target& inner;
+    int shade; // 0..16
+
+    ClipRect clipRect() const {
+        return inner.clipRect();
+    }
+
+    void plot(int x, int y) {
+        if (BAYER_4X4[y & 3][x & 3] < shade) {
+            inner.plot(x, y);
+        }
+    }
+
+    void hspan(int x1, int x2, int y) {
+        if (x1 > x2) {
+            std::swap(x1, x2);
+        }
+        if (shade >= 16) {
+            inner.hspan(x1, x2, y);
+            return;
+        }
+        for (int x = x1; x <= x2; x++) {
+            plot(x, y);
+        }
+    }
+
+    void vspan(int x, int y1, int y2) {
+        if (y1 > y2) {
+            std::swap(y1, y2);
+        }
+        for (int y = y1; y <= y2; y++) {
+            plot(x, y);
+        }
+    }
+};
+
+#endif // POLYGONS_H
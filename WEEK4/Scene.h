@@ -0,0 +1,376 @@
+// --- Demo Scene ---
+// The objects, camera and drawing helpers shared by the X11 demo
+// (PixelManipulationV4.cpp) and the headless benchmark (Benchmark.cpp).
+#ifndef SCENE_H
+#define SCENE_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <utility>
+#include <vector>
+#include "Circles.h"
+#include "DepthBuffer.h"
+#include "DirtyRects.h"
+#include "EdgeBuilder.h"
+#include "Ellipses.h"
+#include "Instances.h"
+#include "Lines.h"
+#include "Polygons.h"
+#include "Transform.h"
+#include "Triangles.h"
+
+const int WINDOW_WIDTH = 600;
+const int WINDOW_HEIGHT = 600;
+
+// Cuts each (convex) face into a fan of triangles around its first corner.
+inline std::vector<std::array<int, 3>> triangulateFaces(const std::vector<std::vector<int>>& faces) {
+    std::vector<std::array<int, 3>> triangles;
+    for (const auto& corners : faces) {
+        for (size_t i = 1; i + 1 < corners.size(); i++) {
+            triangles.push_back({corners[0], corners[i], corners[i + 1]});
+        }
+    }
+    return triangles;
+}
+
+
+// --- Objects ---
+const std::vector<Point3D> cube_vertices = {
+    {-20, -20, -20}, {20, -20, -20}, {20, 20, -20}, {-20, 20, -20},
+    {-20, -20, 20},  {20, -20, 20},  {20, 20, 20},  {-20, 20, 20}
+};
+const std::vector<std::pair<int, int>> cube_edges = {
+    {0, 1}, {1, 2}, {2, 3}, {3, 0}, {4, 5}, {5, 6}, {6, 7}, {7, 4},
+    {0, 4}, {1, 5}, {2, 6}, {3, 7}
+};
+// The cube's faces, each wound counter-clockwise seen from outside the cube
+const std::vector<std::vector<int>> cube_faces = {
+    {0, 3, 2, 1}, {4, 5, 6, 7}, {0, 1, 5, 4}, {3, 7, 6, 2}, {0, 4, 7, 3}, {1, 2, 6, 5}
+};
+const std::vector<std::array<int, 3>> cube_triangles = triangulateFaces(cube_faces);
+const std::vector<Point3D> rayquaza_spine_vertices = {
+    {  0,   0,   0}, { 20,   5, -10}, { 30,  15, -20}, { 25,  30, -30}, { 10,  40, -40},
+    {-10,  35, -50}, {-20,  20, -60}, {-15,   5, -70}, {  0,   0, -80}, { 10,  -5, -90},
+    { 20, -10, -100},{ 15, -20, -110},{  0, -25, -120},{-10, -20, -130},{-20, -15, -140}
+};
+const std::vector<std::pair<int, int>> rayquaza_spine_edges = EdgeBuilder::build(rayquaza_spine_vertices);
+// A mesh loaded with --obj is scaled to this size (its largest side, in
+// model units), about the length of the spine it replaces
+const float OBJ_MODEL_SIZE = 150.0f;
+
+
+// --- Scene Camera ---
+// A perspective camera at the origin. FOCAL_LENGTH is chosen so that at
+// depth FOCAL_LENGTH one model unit is exactly one pixel: objects placed
+// there keep the on-screen size they had with the old flat XZ rotation,
+// and perspective only shows up as their own depth varies.
+const float FOCAL_LENGTH = 400.0f;
+
+inline Mat4 sceneViewProjection() {
+    float fov_y = 2.0f * std::atan((WINDOW_HEIGHT / 2.0f) / FOCAL_LENGTH);
+    Mat4 projection = Mat4::perspective(fov_y, (float)WINDOW_WIDTH / WINDOW_HEIGHT, 1.0f, 4000.0f);
+    Mat4 view = Mat4::identity(); // Camera at the origin, looking down -z
+    return projection * view;
+}
+
+// Model matrix for an object spinning by "angle" whose center appears at
+// screen position (screenX, screenY).
+inline Mat4 objectModelMatrix(float angle, float screenX, float screenY) {
+    return Mat4::translation(screenX - WINDOW_WIDTH / 2.0f, screenY - WINDOW_HEIGHT / 2.0f, -FOCAL_LENGTH) *
+           Mat4::rotationY(angle);
+}
+
+// --- Scene Animation ---
+// Where the objects are drawn: their screen positions and spin angle.
+struct ScenePose {
+    float angle;
+    float cube_x, cube_y;
+    float spine_x, spine_y;
+};
+
+// The bouncing, spinning cube and the slowly turning spine.
+struct SceneAnimation {
+    float angle = 0.0f;
+    int cube_x = 200, cube_y = 200, cube_dx = 1, cube_dy = 1;
+    int spine_x = 400, spine_y = 300;
+
+    // Update cube position + rotation, once per simulation step
+    void step() {
+        angle += 0.015f;
+        cube_x += cube_dx;
+        cube_y += cube_dy;
+        if (cube_x <= 40 || cube_x >= 560) cube_dx *= -1;
+        if (cube_y <= 40 || cube_y >= 560) cube_dy *= -1;
+    }
+
+    ScenePose pose() const {
+        return {angle, (float)cube_x, (float)cube_y, (float)spine_x, (float)spine_y};
+    }
+};
+
+// --- Fixed Timestep ---
+// The animation always steps SIMULATION_HZ times per second of real time,
+// however fast frames are rendered (30, 60, 144 fps or uncapped), so it
+// looks the same and does the same work at any frame rate. A frame usually
+// falls between two steps; it then shows the pose interpolated between the
+// previous and the current step by how far time has moved past the latter.
+struct SceneSimulation {
+    static constexpr double SIMULATION_HZ = 60.0; // The old once-per-frame speed at 60 fps
+    static constexpr double STEP_SECONDS = 1.0 / SIMULATION_HZ;
+    // After a long stall (e.g. the window was dragged) don't try to make up
+    // for more than this much time in one frame.
+    static constexpr double MAX_CATCH_UP_SECONDS = 0.25;
+
+    SceneAnimation previous, current;
+    double accumulator = 0.0; // Real time not yet simulated
+    long long steps = 0;
+
+    // Runs as many fixed steps as the elapsed real time calls for.
+    void advance(double elapsed_seconds) {
+        accumulator += std::min(elapsed_seconds, MAX_CATCH_UP_SECONDS);
+        while (accumulator >= STEP_SECONDS) {
+            previous = current;
+            current.step();
+            accumulator -= STEP_SECONDS;
+            steps++;
+        }
+    }
+
+    ScenePose pose() const {
+        float t = static_cast<float>(accumulator / STEP_SECONDS);
+        ScenePose a = previous.pose(), b = current.pose();
+        return {a.angle + (b.angle - a.angle) * t,
+                a.cube_x + (b.cube_x - a.cube_x) * t, a.cube_y + (b.cube_y - a.cube_y) * t,
+                a.spine_x + (b.spine_x - a.spine_x) * t, a.spine_y + (b.spine_y - a.spine_y) * t};
+    }
+};
+
+// The cube and spine vertex arrays plus their screen positions this frame.
+struct SceneMeshes {
+    VertexArray cube = makeVertexArray(cube_vertices);
+    VertexArray spine = makeVertexArray(rayquaza_spine_vertices);
+    ScreenVertices cube_screen, spine_screen;
+    Mat4 view_projection = sceneViewProjection();
+    Viewport viewport = {0, 0, (float)WINDOW_WIDTH, (float)WINDOW_HEIGHT};
+
+    // A mesh loaded from an .obj file (ObjLoader.h). When there is one it
+    // takes the spine's place, and spine_screen holds its vertices instead.
+    VertexArray model;
+    std::vector<std::pair<int, int>> model_edges;
+    std::vector<std::array<int, 3>> model_triangles;
+
+    bool hasModel() const {
+        return !model.x.empty();
+    }
+
+    const std::vector<std::pair<int, int>>& spineEdges() const {
+        return hasModel() ? model_edges : rayquaza_spine_edges;
+    }
+
+    // Stress mode (Instances.h): copies of the cube bouncing around on their
+    // own, drawn as one big mesh. They are stepped by whoever runs the
+    // simulation; transform only places and projects them.
+    CubeInstances instances;
+    VertexArray instances_world;
+    ScreenVertices instances_screen;
+    std::vector<std::pair<int, int>> instance_edges;
+    std::vector<std::array<int, 3>> instance_triangles;
+
+    void spawnInstances(size_t count, unsigned seed) {
+        instances.spawn(std::min(count, MAX_INSTANCES), seed);
+        instance_edges = instanceEdges(cube_edges, instances.size());
+        instance_triangles = instanceTriangles(cube_triangles, instances.size());
+    }
+
+    // Transform each vertex once; every backend then draws edges by index
+    void transform(const ScenePose& pose) {
+        transformVertices(cube, view_projection * objectModelMatrix(pose.angle, pose.cube_x, pose.cube_y),
+                          viewport, cube_screen);
+        transformVertices(hasModel() ? model : spine,
+                          view_projection * objectModelMatrix(-pose.angle * 0.5f, pose.spine_x, pose.spine_y),
+                          viewport, spine_screen);
+        if (instances.size() > 0) {
+            instances.place(cube, -WINDOW_WIDTH / 2.0f, -WINDOW_HEIGHT / 2.0f, -FOCAL_LENGTH, instances_world);
+            transformVertices(instances_world, view_projection, viewport, instances_screen);
+        }
+    }
+};
+
+// General 3D wireframe drawing (uses the selected line algorithm). The
+// edges may use any index type (EdgeBuilder.h).
+template <typename Target, typename Index>
+void drawEdges(Target& target, const ScreenVertices& vertices,
+               const std::vector<std::pair<Index, Index>>& edges, DrawAlgorithm algo) {
+    for (const auto& edge : edges) {
+        drawLine(target, algo, vertices.x[edge.first], vertices.y[edge.first],
+                 vertices.x[edge.second], vertices.y[edge.second]);
+    }
+}
+
+// Solid drawing: fills every triangle of a mesh, whichever way it faces.
+template <typename Target>
+void fillTriangles(Target& target, const ScreenVertices& vertices, const std::vector<std::array<int, 3>>& triangles) {
+    for (const auto& t : triangles) {
+        fillTriangle(target, vertices.x[t[0]], vertices.y[t[0]], vertices.x[t[1]], vertices.y[t[1]],
+                     vertices.x[t[2]], vertices.y[t[2]]);
+    }
+}
+
+// Hidden-line drawing: like drawEdges, but every pixel is depth-tested
+// (DepthBuffer.h). The depth test needs the depth of each pixel, so these
+// lines are always Bresenham's, whatever algorithm is selected.
+template <typename Target, typename Index>
+void drawEdgesDepth(Target& target, DepthBuffer& depth, const ScreenVertices& vertices,
+                    const std::vector<std::pair<Index, Index>>& edges) {
+    for (const auto& edge : edges) {
+        drawLineDepth(target, depth, vertices.x[edge.first], vertices.y[edge.first], vertices.z[edge.first],
+                      vertices.x[edge.second], vertices.y[edge.second], vertices.z[edge.second]);
+    }
+}
+
+// The depth prepass: writes a closed mesh's triangles into the depth
+// buffer only, inside "clip". Only the ones facing the camera (positive
+// area on screen, like the cube's faces in drawSolidCube): on a closed mesh
+// the others are always behind them, so that halves the work.
+inline void writeTriangleDepth(DepthBuffer& depth, const ClipRect& clip, const ScreenVertices& vertices,
+                               const std::vector<std::array<int, 3>>& triangles) {
+    for (const auto& t : triangles) {
+        int ax = vertices.x[t[0]], ay = vertices.y[t[0]], bx = vertices.x[t[1]], by = vertices.y[t[1]];
+        int cx = vertices.x[t[2]], cy = vertices.y[t[2]];
+        if ((long long)(bx - ax) * (cy - ay) <= (long long)(by - ay) * (cx - ax)) {
+            continue; // Facing away, or seen edge-on (covers no pixel and has no plane)
+        }
+        DepthPlaneTarget plane(depth, clip, ax, ay, vertices.z[t[0]], bx, by, vertices.z[t[1]], cx, cy,
+                               vertices.z[t[2]]);
+        fillTriangle(plane, ax, ay, bx, by, cx, cy);
+    }
+}
+
+// Like drawEdges, but collects the screen-space lines instead of drawing
+// them, for renderers that need the whole frame up front.
+template <typename Index>
+void appendEdgeLines(std::vector<Line>& out, const ScreenVertices& vertices,
+                     const std::vector<std::pair<Index, Index>>& edges) {
+    for (const auto& edge : edges) {
+        out.push_back({vertices.x[edge.first], vertices.y[edge.first],
+                       vertices.x[edge.second], vertices.y[edge.second]});
+    }
+}
+
+// --- Solid Cube ---
+// Fills the cube's faces that point at the camera; on screen their corners
+// come out in the opposite (positive area) order from the faces pointing
+// away. The cube is convex, so those faces never overlap and no depth test
+// is needed. Each face is shaded by how squarely it faces the camera: its
+// screen area against the area it has when facing the camera head-on
+// (40 x 40 model units, one pixel each at FOCAL_LENGTH). Then only the
+// edges of those faces are drawn, each once, so the back edges are hidden.
+template <typename Target>
+void drawSolidCube(Target& target, const ScreenVertices& vertices, DrawAlgorithm algo) {
+    const long long FACING_AREA2 = 2 * 40 * 40; // Twice the area, like the shoelace sum below
+    unsigned visible_edges = 0; // Bit e set: cube_edges[e] belongs to a face we see
+    for (const auto& corners : cube_faces) {
+        long long area2 = 0;
+        for (size_t i = 0; i < corners.size(); i++) {
+            int a = corners[i], b = corners[(i + 1) % corners.size()];
+            area2 += (long long)vertices.x[a] * vertices.y[b] - (long long)vertices.x[b] * vertices.y[a];
+        }
+        if (area2 <= 0) {
+            continue; // Facing away
+        }
+        for (size_t i = 0; i < corners.size(); i++) {
+            int a = corners[i], b = corners[(i + 1) % corners.size()];
+            for (size_t e = 0; e < cube_edges.size(); e++) {
+                if (cube_edges[e] == std::make_pair(a, b) || cube_edges[e] == std::make_pair(b, a)) {
+                    visible_edges |= 1u << e;
+                }
+            }
+        }
+        // Head-on faces are the lightest, faces seen edge-on the darkest
+        double facing = std::min(1.0, (double)area2 / FACING_AREA2);
+        DitheredTarget<Target> shaded = {target, 4 + static_cast<int>(std::lround((1.0 - facing) * 8))};
+        // Filled as a fan of triangles; they share edges without overlapping
+        for (size_t i = 1; i + 1 < corners.size(); i++) {
+            int a = corners[0], b = corners[i], c = corners[i + 1];
+            fillTriangle(shaded, vertices.x[a], vertices.y[a], vertices.x[b], vertices.y[b], vertices.x[c],
+                         vertices.y[c]);
+        }
+    }
+    for (size_t e = 0; e < cube_edges.size(); e++) {
+        if (visible_edges & (1u << e)) {
+            const auto& edge = cube_edges[e];
+            drawLine(target, algo, vertices.x[edge.first], vertices.y[edge.first], vertices.x[edge.second],
+                     vertices.y[edge.second]);
+        }
+    }
+}
+
+// Draws the moving objects that can touch "rect" into a target whose
+// clipRect() is that rectangle. The static shapes come from the retained
+// layer (StaticLayer.h) and are not redrawn here. With "solid_cube" the
+// cube is drawn with filled faces instead of as a wireframe. With a depth
+// buffer (cleared once for the frame) hidden lines are removed: the cube's
+// faces go into it first, then the edges are drawn depth-tested.
+template <typename Target>
+void drawMeshesInRect(Target& target, const ClipRect& rect, const SceneMeshes& meshes, DrawAlgorithm algo,
+                      bool solid_cube = false, DepthBuffer* depth = nullptr) {
+    if (rectsOverlap(vertexBounds(meshes.cube_screen), rect)) {
+        if (depth) {
+            writeTriangleDepth(*depth, rect, meshes.cube_screen, cube_triangles);
+        }
+        if (solid_cube) {
+            drawSolidCube(target, meshes.cube_screen, algo);
+        } else if (depth) {
+            drawEdgesDepth(target, *depth, meshes.cube_screen, cube_edges);
+        } else {
+            drawEdges(target, meshes.cube_screen, cube_edges, algo);
+        }
+    }
+    // The spine, or the loaded mesh in its place; a mesh hides its own back
+    // lines too, so its faces go into the depth buffer like the cube's
+    if (rectsOverlap(vertexBounds(meshes.spine_screen), rect)) {
+        if (depth) {
+            writeTriangleDepth(*depth, rect, meshes.spine_screen, meshes.model_triangles);
+            drawEdgesDepth(target, *depth, meshes.spine_screen, meshes.spineEdges());
+        } else {
+            drawEdges(target, meshes.spine_screen, meshes.spineEdges(), algo);
+        }
+    }
+    // The stress mode's instances, spread over the whole window (no bounds
+    // test: the clipping stage drops what is outside the rectangle)
+    if (!meshes.instance_edges.empty()) {
+        if (depth) {
+            writeTriangleDepth(*depth, rect, meshes.instances_screen, meshes.instance_triangles);
+            drawEdgesDepth(target, *depth, meshes.instances_screen, meshes.instance_edges);
+        } else {
+            drawEdges(target, meshes.instances_screen, meshes.instance_edges, algo);
+        }
+    }
+}
+
+// Draws all user primitives (lines, circles, ellipses and polygons) through one target.
+template <typename Target>
+void drawUserShapes(Target& target, const std::vector<Line>& user_lines, const std::vector<Circle>& user_circles,
+                    const std::vector<Ellipse>& user_ellipses, const std::vector<Polygon>& user_polygons,
+                    DrawAlgorithm algo) {
+    for (const auto& line : user_lines) {
+        drawLine(target, algo, line.x1, line.y1, line.x2, line.y2);
+    }
+
+    for (const auto& circle : user_circles) {
+        // We only have one circle algorithm (Midpoint/Bresenham's),
+        // drawn as an outline, a filled disc or a ring.
+        drawCircle(target, circle);
+    }
+
+    for (const auto& ellipse : user_ellipses) {
+        drawEllipse(target, ellipse);
+    }
+
+    for (const auto& polygon : user_polygons) {
+        fillPolygon(target, polygon);
+    }
+}
+
+#endif // SCENE_H
@@ -0,0 +1,118 @@
+// --- Retained Static Layer ---
+// The user's lines and circles never change once added, so instead of
+// rasterizing them again every frame they are drawn once into an off-screen
+// layer: a CPU framebuffer here, or a server-side Pixmap for the X backends
+// (PixelManipulationV4.cpp). Each frame then just copies the damaged part
+// of the layer to the screen and draws the moving objects on top, so the
+// frame cost no longer depends on how many shapes the user has drawn.
+//
+// The layer only has to be rasterized again from scratch when the line
+// algorithm changes; new shapes are simply added on top of it.
+#ifndef STATIC_LAYER_H
+#define STATIC_LAYER_H
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include "Circles.h"
+#include "Framebuffer.h"
+#include "Lines.h"
+#include "Scene.h"
+#include "TileRenderer.h"
+
+// What a layer already holds: the shapes up to lines_drawn, circles_drawn,
+// ellipses_drawn and polygons_drawn, rasterized with "algo".
+struct LayerState {
+    bool valid = false;
+    DrawAlgorithm algo = DrawAlgorithm::BRUTE_FORCE;
+    size_t lines_drawn = 0;
+    size_t circles_drawn = 0;
+    size_t ellipses_drawn = 0;
+    size_t polygons_drawn = 0;
+
+    bool needsRebuild(DrawAlgorithm current_algo) const {
+        return !valid || algo != current_algo;
+    }
+
+    void rebuilt(DrawAlgorithm current_algo, size_t line_count, size_t circle_count, size_t ellipse_count,
+                 size_t polygon_count) {
+        valid = true;
+        algo = current_algo;
+        lines_drawn = line_count;
+        circles_drawn = circle_count;
+        ellipses_drawn = ellipse_count;
+        polygons_drawn = polygon_count;
+    }
+};
+
+// Draws only the shapes added since the layer was last brought up to date.
+template <typename Target>
+void drawNewUserShapes(Target& target, LayerState& state, const std::vector<Line>& user_lines,
+                       const std::vector<Circle>& user_circles, const std::vector<Ellipse>& user_ellipses,
+                       const std::vector<Polygon>& user_polygons) {
+    for (size_t i = state.lines_drawn; i < user_lines.size(); i++) {
+        const Line& line = user_lines[i];
+        drawLine(target, state.algo, line.x1, line.y1, line.x2, line.y2);
+    }
+    for (size_t i = state.circles_drawn; i < user_circles.size(); i++) {
+        const Circle& circle = user_circles[i];
+        drawCircle(target, circle);
+    }
+    for (size_t i = state.ellipses_drawn; i < user_ellipses.size(); i++) {
+        drawEllipse(target, user_ellipses[i]);
+    }
+    for (size_t i = state.polygons_drawn; i < user_polygons.size(); i++) {
+        fillPolygon(target, user_polygons[i]);
+    }
+    state.lines_drawn = user_lines.size();
+    state.circles_drawn = user_circles.size();
+    state.ellipses_drawn = user_ellipses.size();
+    state.polygons_drawn = user_polygons.size();
+}
+
+// The static layer for the framebuffer backend.
+struct FramebufferLayer {
+    std::vector<uint32_t> storage;
+    Framebuffer fb;
+    uint32_t background = 0;
+    LayerState state;
+
+    void init(int width, int height, uint32_t foreground, uint32_t background_color) {
+        storage.assign(width * height, background_color);
+        fb.pixels = storage.data();
+        fb.width = width;
+        fb.height = height;
+        fb.stride = width;
+        fb.clip = {0, 0, width - 1, height - 1};
+        fb.color = foreground;
+        background = background_color;
+    }
+
+    // Brings the layer up to date. Full rebuilds may be split over the tiled
+    // renderer's threads; adding a few shapes is not worth waking them.
+    void update(const std::vector<Line>& user_lines, const std::vector<Circle>& user_circles,
+                const std::vector<Ellipse>& user_ellipses, const std::vector<Polygon>& user_polygons,
+                DrawAlgorithm algo, TileRenderer* tiles) {
+        if (state.needsRebuild(algo)) {
+            if (tiles) {
+                tiles->render(fb, background, user_lines, user_circles, user_ellipses, user_polygons, algo);
+            } else {
+                fb.clear(background);
+                drawUserShapes(fb, user_lines, user_circles, user_ellipses, user_polygons, algo);
+            }
+            state.rebuilt(algo, user_lines.size(), user_circles.size(), user_ellipses.size(), user_polygons.size());
+        } else {
+            drawNewUserShapes(fb, state, user_lines, user_circles, user_ellipses, user_polygons);
+        }
+    }
+
+    // Copies one rectangle of the layer into the same place in "target".
+    void copyTo(Framebuffer& target, const ClipRect& r) const {
+        for (int y = r.ymin; y <= r.ymax; y++) {
+            std::copy_n(fb.pixels + y * fb.stride + r.xmin, r.xmax - r.xmin + 1,
+                        target.pixels + y * target.stride + r.xmin);
+        }
+    }
+};
+
+#endif // STATIC_LAYER_H
@@ -0,0 +1,309 @@
+#ifndef TILE_RENDERER_H
+#define TILE_RENDERER_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Circles.h"
+#include "Ellipses.h"
+#include "Framebuffer.h"
+#include "Lines.h"
+#include "Polygons.h"
+
+// --- Tiled Multi-Threaded Framebuffer Rasterizer ---
+// For big scenes the framebuffer is split into TILE_SIZE x TILE_SIZE tiles.
+// Every frame:
+//   1. Binning: each line, circle, ellipse and polygon is added to the list
+//      of every tile it actually touches (Liang-Barsky against the tile for
+//      lines, a distance test for circles, discs and rings, the bounding box
+//      for ellipses and polygons).
+//   2. Rasterizing: worker threads grab tiles one at a time and draw that
+//      tile's primitives with the tile as the clip rectangle. Thanks to the
+//      clipping stage each tile only walks its own part of a line, and
+//      produces exactly the pixels the full-screen loop would.
+// No two threads ever write the same tile, so pixel writes need no locks.
+//
+// With a damage list (see DirtyRects.h) only the tiles it touches are
+// binned, cleared and redrawn; the rest of the framebuffer is left alone.
+struct TileRenderer {
+    static const int TILE_SIZE = 64;
+
+    int tiles_x = 0, tiles_y = 0;
+    int screen_width = 0, screen_height = 0;
+    std::vector<std::vector<int>> tile_lines;   // Per tile: indices into the frame's lines
+    std::vector<std::vector<int>> tile_circles; // Per tile: indices into the frame's circles
+    std::vector<std::vector<int>> tile_ellipses; // Per tile: indices into the frame's ellipses
+    std::vector<std::vector<int>> tile_polygons; // Per tile: indices into the frame's polygons
+    std::vector<char> tile_dirty;               // Per tile: redraw it this frame?
+    std::vector<int> dirty_tiles;               // The tiles to redraw, in order
+
+    // The current frame's job, read by the workers
+    Framebuffer frame;
+    uint32_t clear_color = 0;
+    const std::vector<Line>* lines = nullptr;
+    const std::vector<Circle>* circles = nullptr;
+    const std::vector<Ellipse>* ellipses = nullptr;
+    const std::vector<Polygon>* polygons = nullptr;
+    DrawAlgorithm algo = DrawAlgorithm::BRESENHAM;
+    std::atomic<int> next_tile{0};
+
+    // Worker pool. The main thread renders tiles too, so there are
+    // thread_count - 1 extra threads.
+    std::vector<std::thread> workers;
+    std::mutex pool_mutex;
+    std::condition_variable work_ready, work_done;
+    unsigned long frame_number = 0; // Bumped to wake the workers
+    int workers_busy = 0;
+    bool stopping = false;
+
+    void init(int width, int height, int thread_count) {
+        screen_width = width;
+        screen_height = height;
+        tiles_x = (width + TILE_SIZE - 1) / TILE_SIZE;
+        tiles_y = (height + TILE_SIZE - 1) / TILE_SIZE;
+        tile_lines.assign(tiles_x * tiles_y, {});
+        tile_circles.assign(tiles_x * tiles_y, {});
+        tile_ellipses.assign(tiles_x * tiles_y, {});
+        tile_polygons.assign(tiles_x * tiles_y, {});
+        tile_dirty.assign(tiles_x * tiles_y, 0);
+        dirty_tiles.reserve(tiles_x * tiles_y);
+        for (int i = 1; i < thread_count; i++) {
+            workers.emplace_back([this] { workerLoop(); });
+        }
+    }
+
+    int threadCount() const {
+        return static_cast<int>(workers.size()) + 1;
+    }
+
+    ClipRect tileRect(int tile) const {
+        int x0 = (tile % tiles_x) * TILE_SIZE;
+        int y0 = (tile / tiles_x) * TILE_SIZE;
+        return {x0, y0, std::min(x0 + TILE_SIZE, screen_width) - 1, std::min(y0 + TILE_SIZE, screen_height) - 1};
+    }
+
+    void binLines(const std::vector<Line>& frame_lines) {
+        for (int i = 0; i < (int)frame_lines.size(); i++) {
+            const Line& l = frame_lines[i];
+            // Every algorithm's pixels stay inside the end points' bounding box
+            int tx0 = std::max(std::min(l.x1, l.x2), 0) / TILE_SIZE;
+            int tx1 = std::min(std::max(l.x1, l.x2), screen_width - 1) / TILE_SIZE;
+            int ty0 = std::max(std::min(l.y1, l.y2), 0) / TILE_SIZE;
+            int ty1 = std::min(std::max(l.y1, l.y2), screen_height - 1) / TILE_SIZE;
+            if (std::max(l.x1, l.x2) < 0 || std::max(l.y1, l.y2) < 0 || tx0 > tx1 || ty0 > ty1) {
+                continue; // Entirely off screen
+            }
+            bool single_tile = (tx0 == tx1 && ty0 == ty1);
+            for (int ty = ty0; ty <= ty1; ty++) {
+                for (int tx = tx0; tx <= tx1; tx++) {
+                    int tile = ty * tiles_x + tx;
+                    if (!tile_dirty[tile]) {
+                        continue;
+                    }
+                    double t0, t1;
+                    ClipRect r = tileRect(tile);
+                    // A diagonal line's bounding box covers many tiles it never
+                    // crosses; skip those. Pixels are at most half a pixel off
+                    // the real line, so test against the tile grown by one.
+                    if (single_tile || clipLiangBarsky(l.x1, l.y1, l.x2, l.y2, r.xmin - 1.0, r.ymin - 1.0,
+                                                       r.xmax + 1.0, r.ymax + 1.0, t0, t1)) {
+                        tile_lines[tile].push_back(i);
+                    }
+                }
+            }
+        }
+    }
+
+    void binCircles(const std::vector<Circle>& frame_circles) {
+        for (int i = 0; i < (int)frame_circles.size(); i++) {
+            const Circle& c = frame_circles[i];
+            int tx0 = std::max(c.cx - c.radius, 0) / TILE_SIZE;
+            int tx1 = std::min(c.cx + c.radius, screen_width - 1) / TILE_SIZE;
+            int ty0 = std::max(c.cy - c.radius, 0) / TILE_SIZE;
+            int ty1 = std::min(c.cy + c.radius, screen_height - 1) / TILE_SIZE;
+            if (c.cx + c.radius < 0 || c.cy + c.radius < 0 || tx0 > tx1 || ty0 > ty1) {
+                continue;
+            }
+            for (int ty = ty0; ty <= ty1; ty++) {
+                for (int tx = tx0; tx <= tx1; tx++) {
+                    int tile = ty * tiles_x + tx;
+                    if (!tile_dirty[tile]) {
+                        continue;
+                    }
+                    ClipRect r = tileRect(tile);
+                    // Nearest and farthest distance (squared) from the center to the tile
+                    long long nx = std::max({r.xmin - c.cx, 0, c.cx - r.xmax});
+                    long long ny = std::max({r.ymin - c.cy, 0, c.cy - r.ymax});
+                    long long fx = std::max(std::abs(r.xmin - c.cx), std::abs(r.xmax - c.cx));
+                    long long fy = std::max(std::abs(r.ymin - c.cy), std::abs(r.ymax - c.cy));
+                    // An outline only touches tiles that straddle the radius, a disc
+                    // every tile it reaches, and a ring the tiles outside its hole
+                    int inner_edge = (c.style == CircleStyle::FILLED) ? 0
+                                   : (c.style == CircleStyle::RING) ? c.inner_radius : c.radius;
+                    long long outer = c.radius + 1, inner = std::max(inner_edge - 1, 0);
+                    if (nx * nx + ny * ny <= outer * outer && fx * fx + fy * fy >= inner * inner) {
+                        tile_circles[tile].push_back(i);
+                    }
+                }
+            }
+        }
+    }
+
+    void binEllipses(const std::vector<Ellipse>& frame_ellipses) {
+        for (int i = 0; i < (int)frame_ellipses.size(); i++) {
+            binBounds(ellipseBounds(frame_ellipses[i]), tile_ellipses, i);
+        }
+    }
+
+    void binPolygons(const std::vector<Polygon>& frame_polygons) {
+        for (int i = 0; i < (int)frame_polygons.size(); i++) {
+            binBounds(frame_polygons[i].bounds, tile_polygons, i);
+        }
+    }
+
+    // Adds shape i to the list of every dirty tile its bounds touch.
+    void binBounds(const ClipRect& b, std::vector<std::vector<int>>& tile_lists, int i) {
+        int tx0 = std::max(b.xmin, 0) / TILE_SIZE;
+        int tx1 = std::min(b.xmax, screen_width - 1) / TILE_SIZE;
+        int ty0 = std::max(b.ymin, 0) / TILE_SIZE;
+        int ty1 = std::min(b.ymax, screen_height - 1) / TILE_SIZE;
+        if (b.xmax < 0 || b.ymax < 0 || tx0 > tx1 || ty0 > ty1) {
+            return;
+        }
+        for (int ty = ty0; ty <= ty1; ty++) {
+            for (int tx = tx0; tx <= tx1; tx++) {
+                int tile = ty * tiles_x + tx;
+                if (tile_dirty[tile]) {
+                    tile_lists[tile].push_back(i);
+                }
+            }
+        }
+    }
+
+    void renderTile(int tile) {
+        Framebuffer target = frame;
+        target.clip = tileRect(tile);
+
+        target.clearRect(target.clip, clear_color);
+        for (int i : tile_lines[tile]) {
+            const Line& l = (*lines)[i];
+            drawLine(target, algo, l.x1, l.y1, l.x2, l.y2);
+        }
+        for (int i : tile_circles[tile]) {
+            const Circle& c = (*circles)[i];
+            drawCircle(target, c);
+        }
+        for (int i : tile_ellipses[tile]) {
+            drawEllipse(target, (*ellipses)[i]);
+        }
+        for (int i : tile_polygons[tile]) {
+            fillPolygon(target, (*polygons)[i]);
+        }
+    }
+
+    // Grabs tiles until none are left. Runs on the workers and the main thread.
+    void renderTiles() {
+        const int tile_count = static_cast<int>(dirty_tiles.size());
+        for (int i = next_tile++; i < tile_count; i = next_tile++) {
+            renderTile(dirty_tiles[i]);
+        }
+    }
+
+    void workerLoop() {
+        unsigned long seen_frame = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(pool_mutex);
+                work_ready.wait(lock, [&] { return stopping || frame_number != seen_frame; });
+                if (stopping) {
+                    return;
+                }
+                seen_frame = frame_number;
+            }
+            renderTiles();
+            {
+                std::lock_guard<std::mutex> lock(pool_mutex);
+                workers_busy--;
+            }
+            work_done.notify_one();
+        }
+    }
+
+    // Marks the tiles touched by the damage rectangles, or every tile.
+    void markDirtyTiles(const std::vector<ClipRect>* damage) {
+        std::fill(tile_dirty.begin(), tile_dirty.end(), damage ? 0 : 1);
+        if (damage) {
+            for (const ClipRect& r : *damage) {
+                for (int ty = r.ymin / TILE_SIZE; ty <= r.ymax / TILE_SIZE; ty++) {
+                    for (int tx = r.xmin / TILE_SIZE; tx <= r.xmax / TILE_SIZE; tx++) {
+                        tile_dirty[ty * tiles_x + tx] = 1;
+                    }
+                }
+            }
+        }
+        dirty_tiles.clear();
+        for (int tile = 0; tile < tiles_x * tiles_y; tile++) {
+            if (tile_dirty[tile]) {
+                dirty_tiles.push_back(tile);
+            }
+        }
+    }
+
+    // Clears the framebuffer to background and draws all lines, circles,
+    // ellipses and polygons.
+    // With "damage" (rectangles inside the screen) only the tiles those
+    // rectangles touch are redrawn.
+    void render(Framebuffer& fb, uint32_t background, const std::vector<Line>& frame_lines,
+                const std::vector<Circle>& frame_circles, const std::vector<Ellipse>& frame_ellipses,
+                const std::vector<Polygon>& frame_polygons, DrawAlgorithm frame_algo,
+                const std::vector<ClipRect>* damage = nullptr) {
+        // The per-tile lists keep their capacity, so after the first few
+        // frames binning does not allocate.
+        for (auto& list : tile_lines) list.clear();
+        for (auto& list : tile_circles) list.clear();
+        for (auto& list : tile_ellipses) list.clear();
+        for (auto& list : tile_polygons) list.clear();
+        markDirtyTiles(damage);
+        binLines(frame_lines);
+        binCircles(frame_circles);
+        binEllipses(frame_ellipses);
+        binPolygons(frame_polygons);
+
+        frame = fb;
+        clear_color = background;
+        lines = &frame_lines;
+        circles = &frame_circles;
+        ellipses = &frame_ellipses;
+        polygons = &frame_polygons;
+        algo = frame_algo;
+        next_tile = 0;
+        {
+            std::lock_guard<std::mutex> lock(pool_mutex);
+            workers_busy = static_cast<int>(workers.size());
+            frame_number++;
+        }
+        work_ready.notify_all();
+
+        renderTiles();
+
+        std::unique_lock<std::mutex> lock(pool_mutex);
+        work_done.wait(lock, [&] { return workers_busy == 0; });
+    }
+
+    void shutdown() {
+        {
+            std::lock_guard<std::mutex> lock(pool_mutex);
+            stopping = true;
+        }
+        work_ready.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        workers.clear();
+    }
+};
+
+#endif // TILE_RENDERER_H
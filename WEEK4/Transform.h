@@ -0,0 +1,190 @@
+#ifndef TRANSFORM_H
+#define TRANSFORM_H
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#if defined(__SSE2__) || defined(__AVX__)
+#include <immintrin.h> // SIMD vertex transform
+#endif
+
+struct Point3D {
+    float x, y, z;
+};
+
+// --- 4x4 Matrices ---
+// Row-major (m[row * 4 + col]) and points are column vectors, so p' = M * p
+// and in A * B the transform B is applied first.
+struct Mat4 {
+    float m[16];
+
+    static Mat4 identity() {
+        return {{1, 0, 0, 0,
+                 0, 1, 0, 0,
+                 0, 0, 1, 0,
+                 0, 0, 0, 1}};
+    }
+
+    static Mat4 translation(float x, float y, float z) {
+        return {{1, 0, 0, x,
+                 0, 1, 0, y,
+                 0, 0, 1, z,
+                 0, 0, 0, 1}};
+    }
+
+    // Rotation around the Y axis, i.e. in the XZ plane
+    static Mat4 rotationY(float angle) {
+        float c = std::cos(angle), s = std::sin(angle);
+        return {{ c, 0, -s, 0,
+                  0, 1,  0, 0,
+                  s, 0,  c, 0,
+                  0, 0,  0, 1}};
+    }
+
+    // OpenGL-style perspective: the camera looks down -z and w = -z, so the
+    // perspective divide makes far things smaller. fov_y is in radians.
+    static Mat4 perspective(float fov_y, float aspect, float near_z, float far_z) {
+        float f = 1.0f / std::tan(fov_y / 2.0f);
+        return {{f / aspect, 0, 0, 0,
+                 0, f, 0, 0,
+                 0, 0, (far_z + near_z) / (near_z - far_z), 2.0f * far_z * near_z / (near_z - far_z),
+                 0, 0, -1, 0}};
+    }
+
+    Mat4 operator*(const Mat4& o) const {
+        Mat4 r;
+        for (int row = 0; row < 4; row++) {
+            for (int col = 0; col < 4; col++) {
+                r.m[row * 4 + col] = m[row * 4 + 0] * o.m[0 * 4 + col] + m[row * 4 + 1] * o.m[1 * 4 + col] +
+                                     m[row * 4 + 2] * o.m[2 * 4 + col] + m[row * 4 + 3] * o.m[3 * 4 + col];
+            }
+        }
+        return r;
+    }
+};
+
+// Maps normalized device coordinates (-1..1) to pixels. Screen y grows
+// downwards and so does our model space y, so there is no flip.
+struct Viewport {
+    float x, y, width, height;
+};
+
+// --- Vertex Transform Stage ---
+// Each frame the vertex array is transformed once into a scratch buffer, and
+// edges then just look up their two end points by index. (Transforming per
+// edge did every cube vertex 3 times.) Both the input and the output are
+// structures of arrays, so the kernel below can load 4 or 8 vertices at a
+// time, and the output buffer keeps its capacity from frame to frame.
+struct VertexArray {
+    std::vector<float> x, y, z;
+};
+
+inline VertexArray makeVertexArray(const std::vector<Point3D>& points) {
+    VertexArray v;
+    for (const Point3D& p : points) {
+        v.x.push_back(p.x);
+        v.y.push_back(p.y);
+        v.z.push_back(p.z);
+    }
+    return v;
+}
+
+// Depth runs from 0 at the near plane to DEPTH_MAX at the far plane, in
+// 24 bits (DepthBuffer.h keeps a frame tag in the other 8). It is the
+// perspective-divided z, so it changes linearly across the screen and
+// rasterizers can interpolate it like x and y.
+const int DEPTH_BITS = 24;
+const int DEPTH_MAX = (1 << DEPTH_BITS) - 1;
+
+struct ScreenVertices {
+    std::vector<int> x, y;
+    std::vector<int> z; // Depth, 0..DEPTH_MAX
+};
+
+// Screen positions are clamped to +/-2^20 so points far off screen (or
+// nearly on the camera plane) still leave the rasterizers' integer math
+// plenty of headroom; the clipping stage takes care of the rest.
+const float SCREEN_COORD_LIMIT = 1048576.0f;
+
+// Model-view-projection, perspective divide and viewport transform for a
+// whole vertex array. Vertices are expected in front of the camera (w > 0);
+// w is clamped to a tiny positive value so nothing divides by zero.
+inline void transformVertices(const VertexArray& in, const Mat4& mvp, const Viewport& viewport,
+                              ScreenVertices& out) {
+    const size_t count = in.x.size();
+    out.x.resize(count);
+    out.y.resize(count);
+    out.z.resize(count);
+
+    const float* __restrict px = in.x.data();
+    const float* __restrict py = in.y.data();
+    const float* __restrict pz = in.z.data();
+    int* __restrict screen_x = out.x.data();
+    int* __restrict screen_y = out.y.data();
+    int* __restrict screen_z = out.z.data();
+    const float* m = mvp.m;
+
+    // Viewport: screen = ndc * scale + offset
+    const float scale_x = viewport.width * 0.5f, offset_x = viewport.x + scale_x;
+    const float scale_y = viewport.height * 0.5f, offset_y = viewport.y + scale_y;
+    // Depth: (ndc z * 0.5 + 0.5) * DEPTH_MAX, clamped to the depth range
+    const float scale_z = DEPTH_MAX * 0.5f, offset_z = DEPTH_MAX * 0.5f;
+    const float min_w = 1e-6f;
+
+    size_t i = 0;
+#if defined(__AVX__)
+    // 8 vertices per iteration
+    for (; i + 8 <= count; i += 8) {
+        __m256 x = _mm256_loadu_ps(px + i), y = _mm256_loadu_ps(py + i), z = _mm256_loadu_ps(pz + i);
+        auto row = [&](int r) {
+            __m256 v = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(m[r * 4 + 0]), x),
+                                     _mm256_mul_ps(_mm256_set1_ps(m[r * 4 + 1]), y));
+            v = _mm256_add_ps(v, _mm256_mul_ps(_mm256_set1_ps(m[r * 4 + 2]), z));
+            return _mm256_add_ps(v, _mm256_set1_ps(m[r * 4 + 3]));
+        };
+        __m256 w = _mm256_max_ps(row(3), _mm256_set1_ps(min_w));
+        __m256 sx = _mm256_add_ps(_mm256_mul_ps(_mm256_div_ps(row(0), w), _mm256_set1_ps(scale_x)), _mm256_set1_ps(offset_x));
+        __m256 sy = _mm256_add_ps(_mm256_mul_ps(_mm256_div_ps(row(1), w), _mm256_set1_ps(scale_y)), _mm256_set1_ps(offset_y));
+        sx = _mm256_min_ps(_mm256_max_ps(sx, _mm256_set1_ps(-SCREEN_COORD_LIMIT)), _mm256_set1_ps(SCREEN_COORD_LIMIT));
+        sy = _mm256_min_ps(_mm256_max_ps(sy, _mm256_set1_ps(-SCREEN_COORD_LIMIT)), _mm256_set1_ps(SCREEN_COORD_LIMIT));
+        __m256 sz = _mm256_add_ps(_mm256_mul_ps(_mm256_div_ps(row(2), w), _mm256_set1_ps(scale_z)), _mm256_set1_ps(offset_z));
+        sz = _mm256_min_ps(_mm256_max_ps(sz, _mm256_setzero_ps()), _mm256_set1_ps((float)DEPTH_MAX));
+        _mm256_storeu_si256((__m256i*)(screen_x + i), _mm256_cvttps_epi32(sx));
+        _mm256_storeu_si256((__m256i*)(screen_y + i), _mm256_cvttps_epi32(sy));
+        _mm256_storeu_si256((__m256i*)(screen_z + i), _mm256_cvttps_epi32(sz));
+    }
+#endif
+#if defined(__SSE2__)
+    // 4 vertices per iteration (all x86-64 CPUs have SSE2)
+    for (; i + 4 <= count; i += 4) {
+        __m128 x = _mm_loadu_ps(px + i), y = _mm_loadu_ps(py + i), z = _mm_loadu_ps(pz + i);
+        auto row = [&](int r) {
+            __m128 v = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(m[r * 4 + 0]), x), _mm_mul_ps(_mm_set1_ps(m[r * 4 + 1]), y));
+            v = _mm_add_ps(v, _mm_mul_ps(_mm_set1_ps(m[r * 4 + 2]), z));
+            return _mm_add_ps(v, _mm_set1_ps(m[r * 4 + 3]));
+        };
+        __m128 w = _mm_max_ps(row(3), _mm_set1_ps(min_w));
+        __m128 sx = _mm_add_ps(_mm_mul_ps(_mm_div_ps(row(0), w), _mm_set1_ps(scale_x)), _mm_set1_ps(offset_x));
+        __m128 sy = _mm_add_ps(_mm_mul_ps(_mm_div_ps(row(1), w), _mm_set1_ps(scale_y)), _mm_set1_ps(offset_y));
+        sx = _mm_min_ps(_mm_max_ps(sx, _mm_set1_ps(-SCREEN_COORD_LIMIT)), _mm_set1_ps(SCREEN_COORD_LIMIT));
+        sy = _mm_min_ps(_mm_max_ps(sy, _mm_set1_ps(-SCREEN_COORD_LIMIT)), _mm_set1_ps(SCREEN_COORD_LIMIT));
+        __m128 sz = _mm_add_ps(_mm_mul_ps(_mm_div_ps(row(2), w), _mm_set1_ps(scale_z)), _mm_set1_ps(offset_z));
+        sz = _mm_min_ps(_mm_max_ps(sz, _mm_setzero_ps()), _mm_set1_ps((float)DEPTH_MAX));
+        _mm_storeu_si128((__m128i*)(screen_x + i), _mm_cvttps_epi32(sx));
+        _mm_storeu_si128((__m128i*)(screen_y + i), _mm_cvttps_epi32(sy));
+        _mm_storeu_si128((__m128i*)(screen_z + i), _mm_cvttps_epi32(sz));
+    }
+#endif
+    // Leftover vertices (or everything, without SIMD): same math, one at a time
+    for (; i < count; i++) {
+        float w = std::max(m[12] * px[i] + m[13] * py[i] + m[14] * pz[i] + m[15], min_w);
+        float sx = (m[0] * px[i] + m[1] * py[i] + m[2] * pz[i] + m[3]) / w * scale_x + offset_x;
+        float sy = (m[4] * px[i] + m[5] * py[i] + m[6] * pz[i] + m[7]) / w * scale_y + offset_y;
+        screen_x[i] = static_cast<int>(std::min(std::max(sx, -SCREEN_COORD_LIMIT), SCREEN_COORD_LIMIT));
+        screen_y[i] = static_cast<int>(std::min(std::max(sy, -SCREEN_COORD_LIMIT), SCREEN_COORD_LIMIT));
+        float sz = (m[8] * px[i] + m[9] * py[i] + m[10] * pz[i] + m[11]) / w * scale_z + offset_z;
+        screen_z[i] = static_cast<int>(std::min(std::max(sz, 0.0f), (float)DEPTH_MAX));
+    }
+}
+
+#endif // TRANSFORM_H
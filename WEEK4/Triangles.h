@@ -0,0 +1,253 @@
+// --- Triangle Rasterizer (Edge Functions) ---
+// Each edge of a triangle splits the plane in two: its edge function
+//
+//   E(x, y) = A * x + B * y + C
+//
+// is zero on the edge, positive on the triangle's side and negative on the
+// other. A pixel center is inside when all three are positive. E is linear,
+// so it is cheap to step (+A one pixel right, +B one pixel down), and over a
+// rectangle its smallest and largest values sit in two of the corners.
+//
+// The triangle's bounding box is walked in 8x8 blocks, each row of blocks
+// only where its edges leave room for the triangle:
+//   - a block where one edge is negative in all four corners is skipped,
+//   - a block where all edges are positive in all four corners is covered
+//     in full, without looking at its pixels,
+//   - any other block is tested pixel by pixel, a row of 8 at a time with
+//     SIMD: AVX2 (8 lanes) when built with -mavx2 or -march=native (the
+//     build tasks' default), otherwise SSE2 (2 x 4).
+// The covered pixels of one scanline are always a single run (a triangle is
+// convex), so runs are collected over a row of blocks and drawn as one hspan
+// each.
+//
+// Pixels on an edge follow the "top-left" rule: they belong to the triangle
+// if the edge is a left edge or a horizontal top edge. That is exactly the
+// half-open rule of fillPolygon (Polygons.h), so a triangle fills the same
+// pixels as the 3-corner polygon, and triangles sharing an edge (a mesh, or
+// a face cut in two) never draw a pixel twice or leave a gap.
+#ifndef TRIANGLES_H
+#define TRIANGLES_H
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstdlib>
+#include <utility>
+#if defined(__SSE2__) || defined(__AVX2__)
+#include <immintrin.h> // SIMD block rows
+#endif
+#include "Clip.h"
+#include "Polygons.h"
+
+const int TRIANGLE_BLOCK = 8;
+
+// With all corners within this many pixels of the origin the edge functions
+// fit in 32 bits anywhere inside the triangle (|E| < 2^29). Bigger triangles
+// (a mesh right in front of the camera) go to fillPolygon, which uses 64-bit
+// math and draws the very same pixels.
+const int TRIANGLE_GUARD = 1 << 13;
+
+// E(x, y) = a * x + b * y + c for the edge from (x1, y1) to (x2, y2) of a
+// triangle with positive area, minus one unless the edge is top-left, so
+// that "E >= 0" is the whole inside test.
+struct TriangleEdge {
+    int a, b, c;
+
+    TriangleEdge(int x1, int y1, int x2, int y2) {
+        a = y1 - y2;
+        b = x2 - x1;
+        c = -(a * x1 + b * y1);
+        // Left edge: E grows to the right. Top edge: horizontal, E grows downwards.
+        bool top_left = a > 0 || (a == 0 && b > 0);
+        if (!top_left) {
+            c -= 1;
+        }
+    }
+
+    int at(int x, int y) const {
+        return a * x + b * y + c;
+    }
+};
+
+// Tests the pixels of partially covered blocks a row of 8 at a time. The
+// steps along a row and down a column are the same for every block, so
+// they are set up once per triangle.
+struct TriangleBlockTester {
+#if defined(__AVX2__)
+    __m256i ramp[3], down[3]; // E at x + 0..7 minus E at x; one row down
+#elif defined(__SSE2__)
+    __m128i ramp_left[3], ramp_right[3], down[3]; // The same, as two halves of 4
+#endif
+    TriangleEdge edges[3];
+
+    explicit TriangleBlockTester(const TriangleEdge (&e)[3]) : edges{e[0], e[1], e[2]} {
+#if defined(__AVX2__) || defined(__SSE2__)
+        for (int k = 0; k < 3; k++) {
+            const int a = edges[k].a;
+#if defined(__AVX2__)
+            ramp[k] = _mm256_setr_epi32(0, a, 2 * a, 3 * a, 4 * a, 5 * a, 6 * a, 7 * a);
+            down[k] = _mm256_set1_epi32(edges[k].b);
+#else
+            ramp_left[k] = _mm_setr_epi32(0, a, 2 * a, 3 * a);
+            ramp_right[k] = _mm_setr_epi32(4 * a, 5 * a, 6 * a, 7 * a);
+            down[k] = _mm_set1_epi32(edges[k].b);
+#endif
+        }
+#endif
+    }
+
+    // Sets bit i of masks[r] when pixel (x + i, y + r) is inside, for the
+    // first "rows" rows. e[k] are the edge functions at (x, y).
+    void masks(const int (&e)[3], int rows, unsigned (&masks)[TRIANGLE_BLOCK]) const {
+#if defined(__AVX2__)
+        __m256i w[3];
+        for (int k = 0; k < 3; k++) {
+            w[k] = _mm256_add_epi32(_mm256_set1_epi32(e[k]), ramp[k]);
+        }
+        for (int r = 0; r < rows; r++) {
+            // A sign bit set in any of the three means outside
+            __m256i outside = _mm256_or_si256(_mm256_or_si256(w[0], w[1]), w[2]);
+            masks[r] = ~_mm256_movemask_ps(_mm256_castsi256_ps(outside)) & 0xFF;
+            for (int k = 0; k < 3; k++) {
+                w[k] = _mm256_add_epi32(w[k], down[k]);
+            }
+        }
+#elif defined(__SSE2__)
+        __m128i left[3], right[3];
+        for (int k = 0; k < 3; k++) {
+            __m128i start = _mm_set1_epi32(e[k]);
+            left[k] = _mm_add_epi32(start, ramp_left[k]);
+            right[k] = _mm_add_epi32(start, ramp_right[k]);
+        }
+        for (int r = 0; r < rows; r++) {
+            __m128i outside_left = _mm_or_si128(_mm_or_si128(left[0], left[1]), left[2]);
+            __m128i outside_right = _mm_or_si128(_mm_or_si128(right[0], right[1]), right[2]);
+            int outside = _mm_movemask_ps(_mm_castsi128_ps(outside_left)) |
+                          (_mm_movemask_ps(_mm_castsi128_ps(outside_right)) << 4);
+            masks[r] = ~outside & 0xFF;
+            for (int k = 0; k < 3; k++) {
+                left[k] = _mm_add_epi32(left[k], down[k]);
+                right[k] = _mm_add_epi32(right[k], down[k]);
+            }
+        }
+#else
+        for (int r = 0; r < rows; r++) {
+            masks[r] = 0;
+            for (int i = 0; i < TRIANGLE_BLOCK; i++) {
+                int w0 = e[0] + i * edges[0].a + r * edges[0].b;
+                int w1 = e[1] + i * edges[1].a + r * edges[1].b;
+                int w2 = e[2] + i * edges[2].a + r * edges[2].b;
+                if ((w0 | w1 | w2) >= 0) {
+                    masks[r] |= 1u << i;
+                }
+            }
+        }
+#endif
+    }
+};
+
+// Fills the triangle (either winding) inside the target's clip rectangle.
+template <typename Target>
+void fillTriangle(Target& target, int x0, int y0, int x1, int y1, int x2, int y2) {
+    long long area2 = (long long)(x1 - x0) * (y2 - y0) - (long long)(y1 - y0) * (x2 - x0);
+    if (area2 == 0) {
+        return; // All three corners on one line: no pixel center is strictly inside
+    }
+    if (std::max({std::abs(x0), std::abs(y0), std::abs(x1), std::abs(y1), std::abs(x2), std::abs(y2)}) >
+        TRIANGLE_GUARD) {
+        thread_local Polygon big; // Keeps its buffers between calls
+        big.x = {x0, x1, x2};
+        big.y = {y0, y1, y2};
+        buildEdgeTable(big);
+        fillPolygon(target, big);
+        return;
+    }
+    if (area2 < 0) {
+        std::swap(x1, x2);
+        std::swap(y1, y2);
+    }
+
+    const ClipRect rect = target.clipRect();
+    const int xmin = std::max(std::min({x0, x1, x2}), rect.xmin);
+    const int xmax = std::min(std::max({x0, x1, x2}), rect.xmax);
+    const int ymin = std::max(std::min({y0, y1, y2}), rect.ymin);
+    const int ymax = std::min(std::max({y0, y1, y2}), rect.ymax);
+    if (xmin > xmax || ymin > ymax) {
+        return;
+    }
+
+    const TriangleEdge edges[3] = {{x0, y0, x1, y1}, {x1, y1, x2, y2}, {x2, y2, x0, y0}};
+    const TriangleBlockTester tester(edges);
+    // How far each edge function can rise or fall across a block, from its
+    // value in the top-left corner
+    const int S = TRIANGLE_BLOCK - 1;
+    int rise[3], fall[3];
+    for (int k = 0; k < 3; k++) {
+        rise[k] = S * (std::max(edges[k].a, 0) + std::max(edges[k].b, 0));
+        fall[k] = S * (std::min(edges[k].a, 0) + std::min(edges[k].b, 0));
+    }
+
+    // The blocks start at the corner of the bounding box, not on a fixed
+    // grid: small triangles then touch as few blocks as possible.
+    for (int by = ymin; by <= ymax; by += TRIANGLE_BLOCK) {
+        const int rows = std::min(ymax - by + 1, TRIANGLE_BLOCK);
+        // Where the triangle can be in this row of blocks: right of every
+        // left edge and left of every right edge somewhere in its rows
+        // (skipped for narrow triangles, where it costs more than it saves)
+        int x_first = xmin, x_last = xmax;
+        for (int k = 0; k < 3 && xmax - xmin >= 4 * TRIANGLE_BLOCK; k++) {
+            const TriangleEdge& edge = edges[k];
+            long long best = edge.c + (long long)edge.b * (edge.b > 0 ? by + rows - 1 : by); // E at x = 0, best row
+            if (edge.a > 0) {
+                x_first = std::max(x_first, static_cast<int>(-floorDivide(best, edge.a))); // ceil(-best / a)
+            } else if (edge.a < 0) {
+                x_last = std::min(x_last, static_cast<int>(floorDivide(best, -edge.a)));
+            } else if (best < 0) {
+                x_last = x_first - 1; // A horizontal edge with the whole band on its outside
+            }
+        }
+        if (x_first > x_last) {
+            continue;
+        }
+
+        int first[TRIANGLE_BLOCK], last[TRIANGLE_BLOCK];
+        std::fill_n(first, TRIANGLE_BLOCK, INT_MAX);
+        std::fill_n(last, TRIANGLE_BLOCK, INT_MIN);
+        int covered_first = INT_MAX, covered_last = INT_MIN; // Blocks covered in full, all rows
+        int e[3];
+        for (int k = 0; k < 3; k++) {
+            e[k] = edges[k].at(x_first, by);
+        }
+
+        for (int bx = x_first; bx <= x_last; bx += TRIANGLE_BLOCK) {
+            bool outside = e[0] + rise[0] < 0 || e[1] + rise[1] < 0 || e[2] + rise[2] < 0;
+            bool covered = e[0] + fall[0] >= 0 && e[1] + fall[1] >= 0 && e[2] + fall[2] >= 0;
+            if (covered) {
+                covered_first = std::min(covered_first, bx);
+                covered_last = bx + S;
+            } else if (!outside) {
+                unsigned masks[TRIANGLE_BLOCK];
+                tester.masks(e, rows, masks);
+                for (int r = 0; r < rows; r++) {
+                    if (masks[r]) {
+                        first[r] = std::min(first[r], bx + __builtin_ctz(masks[r]));
+                        last[r] = bx + 31 - __builtin_clz(masks[r]);
+                    }
+                }
+            }
+            for (int k = 0; k < 3; k++) {
+                e[k] += TRIANGLE_BLOCK * edges[k].a;
+            }
+        }
+
+        for (int r = 0; r < rows; r++) {
+            int x1 = std::max(std::min(first[r], covered_first), x_first);
+            int x2 = std::min(std::max(last[r], covered_last), x_last);
+            if (x1 <= x2) {
+                target.hspan(x1, x2, by + r);
+            }
+        }
+    }
+}
+
+#endif // TRIANGLES_H